@@ -0,0 +1,54 @@
+#ifndef _BENCH_H_
+#define _BENCH_H_
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Just enough of a harness for Wing3D_Bench. BENCH(name) registers a benchmark that prints its own
+// measurements, running Wing3D_Bench with a name only runs that one. Build with optimizations on.
+struct BENCH_CASE {
+	const char* name;
+	void (*run)();
+};
+inline std::vector<BENCH_CASE>& BenchCases()
+{
+	static std::vector<BENCH_CASE> cases;
+	return cases;
+}
+struct BENCH_REGISTRAR {
+	BENCH_REGISTRAR(const char* name, void (*run)()) { BenchCases().push_back({ name, run }); }
+};
+
+#define BENCH(name) \
+	static void name##_bench(); \
+	static BENCH_REGISTRAR name##_registrar(#name, name##_bench); \
+	static void name##_bench()
+
+// milliseconds the fastest of repeats calls to work took, the fastest is the one least disturbed by the rest of the system
+template<typename Work>
+inline double BestMs(unsigned repeats, Work&& work)
+{
+	double best = 1e30;
+	for (unsigned r = 0; r < repeats; ++r) {
+		auto start = std::chrono::steady_clock::now();
+		work();
+		best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+	}
+	return best;
+}
+
+// results are summed here so the optimizer can't drop the work that produced them
+inline volatile size_t& BenchSink()
+{
+	static volatile size_t sink = 0;
+	return sink;
+}
+
+// absolute path of something in the repository's Assets folder
+inline std::string AssetPath(const char* relative)
+{
+	return std::string(WING3D_SOURCE_DIR) + "/Assets/" + relative;
+}
+#endif
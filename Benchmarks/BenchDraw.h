@@ -0,0 +1,69 @@
+#ifndef _BENCHDRAW_H_
+#define _BENCHDRAW_H_
+#include "../Source/Utils/LevelDraw.h"
+#include "SyntheticLevel.h"
+#include <random>
+
+// Takes every call and drops it, so a timed Record is only LevelDraw's own work.
+// Only counts the calls and the instances the draws would have drawn
+class NullCommands : public RenderCommands
+{
+public:
+	unsigned calls = 0;
+	unsigned long long instances = 0;
+	void WriteBuffer(BUFFER, unsigned, unsigned, const void*, unsigned) override { ++calls; }
+	void SetShaderResource(unsigned, BUFFER, unsigned) override { ++calls; }
+	void SetRootConstants(unsigned, unsigned, const void*, unsigned) override { ++calls; }
+	void SetGeometry(GEOMETRY) override { ++calls; }
+	void DrawIndexedInstanced(unsigned, unsigned instanceCount, unsigned, int, unsigned) override
+	{
+		++calls;
+		instances += instanceCount;
+	}
+};
+
+class NullChunks : public ParallelRenderCommands
+{
+public:
+	std::vector<NullCommands> chunks;
+	void BeginChunks(unsigned count) override { chunks.resize(count); }
+	RenderCommands& Chunk(unsigned index) override { return chunks[index]; }
+	void SubmitChunks() override {}
+};
+
+// A generated level of objectCount objects where every object is an instance set of its own, in shuffled
+// order, so each of its meshes is a draw packet and level order keeps switching model and material
+inline bool LoadPacketLevel(unsigned objectCount, Level_Data& level)
+{
+	const std::string path = WriteSyntheticLevel("Wing3D_PacketBench.txt", objectCount, 0);
+	const bool loaded = level.LoadLevel(path.c_str(), AssetPath("Models").c_str(), GW::SYSTEM::GLog(),
+		Level_Data::IMPORT_16BIT_INDICES);
+	std::error_code error;
+	std::filesystem::remove(path, error);
+	std::vector<Level_Data::MODEL_INSTANCES> sets;
+	for (const Level_Data::MODEL_INSTANCES& instances : level.levelInstances)
+		for (unsigned t = instances.transformStart; t < instances.transformStart + instances.transformCount; ++t) {
+			Level_Data::MODEL_INSTANCES single = instances;
+			single.transformStart = t;
+			single.transformCount = 1;
+			sets.push_back(single);
+		}
+	std::shuffle(sets.begin(), sets.end(), std::mt19937(5));
+	level.levelInstances = sets;
+	return loaded;
+}
+
+// a camera above the edge of the generated square looking across it
+inline void ViewPacketLevel(LevelDraw& draw)
+{
+	GW::MATH::GMATRIXF view, projection;
+	GW::MATH::GVECTORF eye = { 600, 40, -50, 0 }, at = { 600, 0, 600, 0 }, up = { 0, 1, 0, 0 };
+	GW::MATH::GMatrix::LookAtLHF(eye, at, up, view);
+	GW::MATH::GMatrix::ProjectionDirectXLHF(G_DEGREE_TO_RADIAN_F(65), 1, 0.1f, 1000, projection);
+	GW::MATH::GMatrix::MultiplyMatrixF(view, projection, draw.sceneData.viewProjection);
+	draw.sceneData.camPos = eye;
+}
+
+// about the pixels one unit covers at a distance of one unit in a 65 degree, 800 pixel tall view
+static const float benchPixelsPerUnit = 626;
+#endif
@@ -0,0 +1,23 @@
+#include "Bench.h"
+#include <cstring>
+
+// Wing3D_Bench [name]: runs every benchmark, or only the one named
+int main(int argc, char** argv)
+{
+	const char* name = (argc > 1) ? argv[1] : nullptr;
+	unsigned ran = 0;
+	for (const BENCH_CASE& bench : BenchCases()) {
+		if (name != nullptr && std::strcmp(name, bench.name) != 0)
+			continue;
+		std::printf("%s\n", bench.name);
+		bench.run();
+		++ran;
+	}
+	if (ran == 0) {
+		std::printf("no benchmark named %s, choose from:\n", name ? name : "(all)");
+		for (const BENCH_CASE& bench : BenchCases())
+			std::printf("  %s\n", bench.name);
+		return 1;
+	}
+	return 0;
+}
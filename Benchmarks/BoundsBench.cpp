@@ -0,0 +1,39 @@
+#include "Bench.h"
+#include "../Source/Utils/lvlData.h"
+#include <random>
+
+// H2B::ComputeBounds against the scalar reference on 1M vertices and 3M random indices into them,
+// then ComputeLevelBounds over the whole of GameLevel
+BENCH(Bounds)
+{
+	std::mt19937 random(3);
+	std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+	std::vector<H2B::VERTEX> vertices(1 << 20);
+	for (H2B::VERTEX& vertex : vertices)
+		vertex.pos = { position(random), position(random), position(random) };
+	std::vector<unsigned> indices(3 << 20);
+	for (unsigned& index : indices)
+		index = random() % vertices.size();
+	const unsigned vertexCount = static_cast<unsigned>(vertices.size()), indexCount = static_cast<unsigned>(indices.size());
+	double scalar = BestMs(10, [&]() {
+		BenchSink() += static_cast<size_t>(H2B::ComputeBoundsScalar(vertexCount,
+			[&](unsigned i) -> const H2B::VECTOR& { return vertices[i].pos; }).radius);
+	});
+	double simd = BestMs(10, [&]() {
+		BenchSink() += static_cast<size_t>(H2B::ComputeVertexBounds(vertices.data(), vertexCount).radius);
+	});
+	std::printf("  1M vertices: scalar %.2f ms, ComputeVertexBounds %.2f ms (%.1fx)\n", scalar, simd, scalar / simd);
+	scalar = BestMs(5, [&]() {
+		BenchSink() += static_cast<size_t>(H2B::ComputeBoundsScalar(indexCount,
+			[&](unsigned i) -> const H2B::VECTOR& { return vertices[indices[i]].pos; }).radius);
+	});
+	simd = BestMs(5, [&]() {
+		BenchSink() += static_cast<size_t>(H2B::ComputeIndexedBounds(indices.data(), indexCount, vertices.data()).radius);
+	});
+	std::printf("  3M random indices: scalar %.2f ms, ComputeIndexedBounds %.2f ms (%.1fx)\n", scalar, simd, scalar / simd);
+	Level_Data level;
+	level.LoadLevel(AssetPath("GameLevel.txt").c_str(), AssetPath("Models").c_str(), GW::SYSTEM::GLog());
+	double whole = BestMs(20, [&]() { level.ComputeLevelBounds(); });
+	std::printf("  GameLevel (%zu models, %zu meshes): ComputeLevelBounds %.3f ms\n", level.levelModels.size(),
+		level.levelMeshes.size(), whole);
+}
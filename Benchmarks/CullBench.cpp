@@ -0,0 +1,54 @@
+#include "Bench.h"
+#include "../Source/Utils/FrustumCulling.h"
+#include <cstring>
+#include <random>
+
+#if defined(FRUSTUM_CULLING_AVX)
+static const char* cullPath = "AVX, 8 wide";
+#elif defined(FRUSTUM_CULLING_SSE)
+static const char* cullPath = "SSE, 4 wide";
+#else
+static const char* cullPath = "scalar";
+#endif
+
+// CullSpheres against CullSpheresScalar on 1M spheres spread over a 200x20x200 field seen from just above
+// its middle, about 0.5% of them visible. Reading the 16 MB of sphere data once is the floor either can reach.
+BENCH(FrustumCull)
+{
+	const unsigned count = 1000000;
+	CULL_SPHERES spheres;
+	spheres.resize(count, 0);
+	std::mt19937 random(7);
+	std::uniform_real_distribution<float> position(-100.0f, 100.0f), radius(0.1f, 3.0f);
+	for (unsigned i = 0; i < count; ++i) {
+		spheres.x[i] = position(random);
+		spheres.y[i] = position(random) * 0.1f;
+		spheres.z[i] = position(random);
+		spheres.radius[i] = radius(random);
+	}
+	GW::MATH::GMATRIXF view, projection, viewProjection;
+	GW::MATH::GVECTORF eye = { 0.25f, 6.5f, -0.25f, 0 }, at = { 0, 0, 0, 0 }, up = { 0, 1, 0, 0 };
+	GW::MATH::GMatrix::LookAtLHF(eye, at, up, view);
+	GW::MATH::GMatrix::ProjectionDirectXLHF(G_DEGREE_TO_RADIAN_F(65), 1, 0.1f, 100, projection);
+	GW::MATH::GMatrix::MultiplyMatrixF(view, projection, viewProjection);
+	const FRUSTUM frustum = ExtractFrustum(viewProjection);
+	std::vector<unsigned> visible(count + 8), reference(count + 8);
+	unsigned visibleCount = 0, referenceCount = 0;
+	double scalar = BestMs(10, [&]() { referenceCount = CullSpheresScalar(frustum, spheres, 0, count, reference.data()); });
+	double simd = BestMs(100, [&]() { visibleCount = CullSpheres(frustum, spheres, 0, count, visible.data()); });
+	double stream = BestMs(100, [&]() {
+		unsigned bits = 0, word[4];
+		for (unsigned i = 0; i < count; ++i) {
+			std::memcpy(word + 0, &spheres.x[i], 4);
+			std::memcpy(word + 1, &spheres.y[i], 4);
+			std::memcpy(word + 2, &spheres.z[i], 4);
+			std::memcpy(word + 3, &spheres.radius[i], 4);
+			bits |= word[0] | word[1] | word[2] | word[3];
+		}
+		BenchSink() += bits;
+	});
+	const bool same = visibleCount == referenceCount &&
+		std::equal(visible.begin(), visible.begin() + visibleCount, reference.begin());
+	std::printf("  1M spheres, %u visible%s: scalar %.2f ms, CullSpheres (%s) %.2f ms (%.1fx), reading them %.2f ms\n",
+		visibleCount, same ? "" : " (DIFFERS FROM SCALAR)", scalar, cullPath, simd, scalar / simd, stream);
+}
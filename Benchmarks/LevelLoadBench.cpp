@@ -0,0 +1,35 @@
+#include "Bench.h"
+#include "../Source/Utils/lvlData.h"
+#include "SyntheticLevel.h"
+
+// LoadLevel of a generated level, the 21 models are imported once so the time is mostly spent per object
+static void TimeLevel(const char* label, const char* file, unsigned objectCount, unsigned childEvery)
+{
+	const std::string level = WriteSyntheticLevel(file, objectCount, childEvery);
+	const std::string models = AssetPath("Models");
+	unsigned children = 0;
+	size_t objects = 0;
+	double load = BestMs(3, [&]() {
+		Level_Data data;
+		data.LoadLevel(level.c_str(), models.c_str(), GW::SYSTEM::GLog());
+		objects = data.blenderObjects.size();
+		children = 0;
+		for (const Level_Data::BLENDER_OBJECT& object : data.blenderObjects)
+			children += object.parentTransformIndex >= 0;
+	});
+	std::printf("  %s: %zu objects (%u children) loaded in %.1f ms\n", label, objects, children, load);
+	std::error_code error;
+	std::filesystem::remove(level, error);
+}
+
+// ReadGameLevel's single mapped pass over a flat level
+BENCH(LevelRead)
+{
+	TimeLevel("100k MESH blocks", "Wing3D_LevelReadBench.txt", 100000, 0);
+}
+
+// parents resolved through object ids, every fourth object is a child
+BENCH(LevelParents)
+{
+	TimeLevel("100k objects with parents", "Wing3D_LevelParentsBench.txt", 100000, 4);
+}
@@ -0,0 +1,60 @@
+#include "Bench.h"
+#include "BenchDraw.h"
+
+// 24 views orbiting center at eye height, every third from higher up, recorded with frustum culling alone
+// and with occlusion culling too. Instances are summed over the views, times are per view
+static void CompareOcclusion(const char* label, const Level_Data& level, GW::MATH::GVECTORF center, float radius)
+{
+	LevelDraw culled, occluded;
+	for (LevelDraw* draw : { &culled, &occluded }) {
+		draw->frustumCulling = true;
+		draw->packedIndices = draw->meshLods = draw->sortDraws = true;
+		draw->occlusionCulling = draw == &occluded;
+		draw->Reset(level);
+	}
+	unsigned long long culledInstances = 0, occludedInstances = 0, occluderTriangles = 0;
+	double culledMs = 0, occludedMs = 0;
+	const int views = 24;
+	for (int v = 0; v < views; ++v) {
+		const float angle = v * 6.2831853f / views;
+		GW::MATH::GVECTORF eye = { center.x + radius * std::cos(angle), (v % 3 == 2) ? 8.0f : 1.7f,
+			center.z + radius * std::sin(angle), 1 };
+		GW::MATH::GVECTORF at = { center.x, 1.2f, center.z, 1 }, up = { 0, 1, 0, 0 };
+		GW::MATH::GMATRIXF view, projection;
+		GW::MATH::GMatrix::LookAtLHF(eye, at, up, view);
+		GW::MATH::GMatrix::ProjectionDirectXLHF(G_DEGREE_TO_RADIAN_F(65), 1, 0.1f, 100, projection);
+		NullCommands culledCommands, occludedCommands;
+		for (LevelDraw* draw : { &culled, &occluded }) {
+			GW::MATH::GMatrix::MultiplyMatrixF(view, projection, draw->sceneData.viewProjection);
+			draw->sceneData.camPos = eye;
+			NullCommands& commands = draw == &culled ? culledCommands : occludedCommands;
+			double& ms = draw == &culled ? culledMs : occludedMs;
+			ms += BestMs(5, [&]() {
+				commands.instances = 0;
+				draw->Record(level, commands, 0, benchPixelsPerUnit);
+			});
+		}
+		culledInstances += culledCommands.instances;
+		occludedInstances += occludedCommands.instances;
+		occluderTriangles += occluded.OccluderTriangles();
+	}
+	std::printf("  %s: instances drawn %llu -> %llu (%.0f%% fewer), %llu occluder triangles per view, "
+		"record %.2f -> %.2f ms per view\n", label, culledInstances, occludedInstances,
+		culledInstances ? 100.0 * (culledInstances - occludedInstances) / culledInstances : 0.0,
+		occluderTriangles / views, culledMs / views, occludedMs / views);
+}
+
+BENCH(Occlusion)
+{
+	const unsigned options = Level_Data::IMPORT_16BIT_INDICES | Level_Data::IMPORT_LODS;
+	Level_Data game;
+	game.LoadLevel(AssetPath("GameLevel.txt").c_str(), AssetPath("Models").c_str(), GW::SYSTEM::GLog(), options);
+	CompareOcclusion("GameLevel", game, { 0, 0, 0, 1 }, 18);
+	// 20k objects 4 units apart on a 142 x 142 grid, seen from inside it
+	const std::string path = WriteSyntheticLevel("Wing3D_OcclusionBench.txt", 20000, 0);
+	Level_Data grid;
+	grid.LoadLevel(path.c_str(), AssetPath("Models").c_str(), GW::SYSTEM::GLog(), options);
+	std::error_code error;
+	std::filesystem::remove(path, error);
+	CompareOcclusion("20k object grid", grid, { 284, 0, 284, 1 }, 60);
+}
@@ -0,0 +1,64 @@
+#include "Bench.h"
+#include "../Source/Utils/lvlData.h"
+#include <filesystem>
+
+// copies every array the way LoadLevelPackage adopts a section, returns the bytes copied
+template<typename... Arrays>
+static size_t CopyArrays(const Arrays&... arrays)
+{
+	size_t bytes = 0;
+	auto copy = [&bytes](const auto& array) {
+		std::decay_t<decltype(array)> adopted(array.begin(), array.end());
+		bytes += adopted.size() * sizeof(adopted[0]);
+		BenchSink() += adopted.size();
+	};
+	(copy(arrays), ...);
+	return bytes;
+}
+
+// GameLevel imported from GameLevel.txt and the .h2b files against the same level baked into a package.
+// Package sections are copied into the level's vectors, the copy is timed on its own to show what
+// mapping them in place could still save.
+static void ComparePackage(const char* label, unsigned options)
+{
+	const std::string level = AssetPath("GameLevel.txt"), models = AssetPath("Models");
+	const std::string package = (std::filesystem::temp_directory_path() / "Wing3D_LevelPackageBench.lvl").string();
+	Level_Data baked;
+	if (baked.BakeLevel(level.c_str(), models.c_str(), package.c_str(), GW::SYSTEM::GLog(), options) == false) {
+		std::printf("  unable to bake %s\n", package.c_str());
+		return;
+	}
+	double text = BestMs(5, [&]() {
+		Level_Data data;
+		data.LoadLevel(level.c_str(), models.c_str(), GW::SYSTEM::GLog(), options);
+		BenchSink() += data.levelVertices.size();
+	});
+	double mapped = BestMs(20, [&]() {
+		Level_Data data;
+		data.LoadLevelPackage(package.c_str(), GW::SYSTEM::GLog());
+		BenchSink() += data.levelVertices.size();
+	});
+	Level_Data loaded;
+	loaded.LoadLevelPackage(package.c_str(), GW::SYSTEM::GLog());
+	size_t bytes = 0;
+	double copy = BestMs(20, [&]() {
+		bytes = CopyArrays(loaded.levelVertices, loaded.levelIndices, loaded.levelMaterials, loaded.levelTransforms,
+			loaded.levelColliders, loaded.levelBatches, loaded.levelMeshes, loaded.levelModels, loaded.levelInstances,
+			loaded.blenderObjects, loaded.levelCompactVertices, loaded.levelQuantization, loaded.levelIndices16,
+			loaded.levelIndices32, loaded.levelPackedIndices, loaded.levelMeshlets, loaded.levelMeshletRanges,
+			loaded.levelMeshLods, loaded.levelModelBounds, loaded.levelMeshBounds, loaded.levelUniqueMaterials,
+			loaded.levelMeshMaterials, loaded.levelMergedVertices, loaded.levelMergedCompactVertices,
+			loaded.levelMergedIndices, loaded.levelMergedBuckets, loaded.levelMergedRanges);
+	});
+	std::printf("  %s: text + h2b %.2f ms, package %.3f ms (%.0fx), of which copying %.1f MB of sections %.3f ms\n",
+		label, text, mapped, text / mapped, bytes / 1048576.0, copy);
+	std::error_code error;
+	std::filesystem::remove(package, error);
+}
+
+BENCH(LevelPackage)
+{
+	ComparePackage("no import options", Level_Data::IMPORT_DEFAULT);
+	ComparePackage("shipped options", Level_Data::IMPORT_OPTIMIZE_MESHES | Level_Data::IMPORT_WELD_VERTICES |
+		Level_Data::IMPORT_16BIT_INDICES);
+}
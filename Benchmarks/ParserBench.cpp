@@ -0,0 +1,37 @@
+#include "Bench.h"
+#include "../Source/Utils/h2bParser.h"
+#include <filesystem>
+
+// H2B::Parser copies every array out of the file, H2B::MappedParser reads it in place.
+// Both parse every model in Assets/Models and touch what an import would use.
+BENCH(MappedParser)
+{
+	std::vector<std::string> files;
+	std::error_code error;
+	for (const std::filesystem::directory_entry& file : std::filesystem::directory_iterator(AssetPath("Models"), error))
+		if (file.path().extension() == ".h2b")
+			files.push_back(file.path().string());
+	std::sort(files.begin(), files.end());
+	const unsigned rounds = 20;
+	double parse = BestMs(5, [&]() {
+		for (unsigned r = 0; r < rounds; ++r)
+			for (const std::string& file : files) {
+				H2B::Parser parser;
+				parser.Parse(file.c_str());
+				BenchSink() += parser.vertices.size() + parser.indices.size() + parser.meshes.size() + parser.materials.size();
+			}
+	}) / rounds;
+	double mapped = BestMs(5, [&]() {
+		for (unsigned r = 0; r < rounds; ++r)
+			for (const std::string& file : files) {
+				H2B::MappedParser parser;
+				parser.Parse(file.c_str());
+				BenchSink() += parser.vertices.size() + parser.indices.size();
+				for (unsigned m = 0; m < parser.meshCount; ++m)
+					BenchSink() += parser.GetMesh(m).drawInfo.indexCount;
+				for (unsigned m = 0; m < parser.materialCount; ++m)
+					BenchSink() += parser.GetMaterial(m).name != nullptr;
+			}
+	}) / rounds;
+	std::printf("  %zu .h2b files: Parser %.3f ms, MappedParser %.3f ms (%.1fx)\n", files.size(), parse, mapped, parse / mapped);
+}
@@ -0,0 +1,26 @@
+#include "Bench.h"
+#include "BenchDraw.h"
+
+// RecordParallel of about 100k sorted packets split for 1 to 16 threads. ParallelFor never runs more threads
+// than the machine has cores, past that only the cost of extra chunks shows
+BENCH(RecordThreads)
+{
+	Level_Data level;
+	LoadPacketLevel(32000, level);
+	LevelDraw draw;
+	draw.packedIndices = true;
+	draw.sortDraws = true;
+	draw.Reset(level);
+	ViewPacketLevel(draw);
+	NullCommands frame;
+	double serial = BestMs(20, [&]() { draw.Record(level, frame, 0, benchPixelsPerUnit); });
+	std::printf("  %u cores, Record %.2f ms\n", std::thread::hardware_concurrency(), serial);
+	for (unsigned threads : { 1u, 2u, 4u, 8u, 12u, 16u }) {
+		NullChunks chunks;
+		double parallel = BestMs(20, [&]() {
+			draw.RecordParallel(level, frame, chunks, 0, benchPixelsPerUnit, threads);
+		});
+		std::printf("  %2u threads: %zu chunks, RecordParallel %.2f ms (%.2fx)\n", threads, chunks.chunks.size(),
+			parallel, serial / parallel);
+	}
+}
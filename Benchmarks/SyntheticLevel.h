@@ -0,0 +1,35 @@
+#ifndef _SYNTHETICLEVEL_H_
+#define _SYNTHETICLEVEL_H_
+#include <filesystem>
+#include <fstream>
+
+// Writes a level in the exporter's format with objectCount objects spread over a square, cycling through
+// every model in Assets/Models. With childEvery > 0 every childEvery-th object is an indented child of the
+// top level object before it. Returns the level's path in the temp folder.
+inline std::string WriteSyntheticLevel(const char* name, unsigned objectCount, unsigned childEvery)
+{
+	std::vector<std::string> models;
+	std::error_code error;
+	for (const std::filesystem::directory_entry& file : std::filesystem::directory_iterator(AssetPath("Models"), error))
+		if (file.path().extension() == ".h2b")
+			models.push_back(file.path().stem().string());
+	std::sort(models.begin(), models.end());
+	const std::string path = (std::filesystem::temp_directory_path() / name).string();
+	std::ofstream file(path, std::ios_base::trunc);
+	file << "# Game Level Exporter v1.3\n";
+	const unsigned side = static_cast<unsigned>(std::sqrt(double(objectCount))) + 1;
+	char row[128];
+	for (unsigned o = 0; o < objectCount && models.empty() == false; ++o) {
+		const char* indent = (childEvery > 0 && o % childEvery == childEvery - 1) ? "  " : "";
+		file << indent << "MESH\n" << indent << models[o % models.size()] << '.' << o << '\n';
+		std::snprintf(row, sizeof(row), "%s<Matrix 4x4 (1.0000, 0.0000, 0.0000, 0.0000)\n", indent);
+		file << row;
+		file << indent << "            (0.0000, 1.0000, 0.0000, 0.0000)\n";
+		file << indent << "            (0.0000, 0.0000, 1.0000, 0.0000)\n";
+		std::snprintf(row, sizeof(row), "%s            (%.4f, 0.0000, %.4f, 1.0000)>\n", indent,
+			(o % side) * 4.0f, (o / side) * 4.0f);
+		file << row;
+	}
+	return path;
+}
+#endif
@@ -21,7 +21,9 @@ cbuffer SCENE_DATA : register(b0, space0)
 
 cbuffer MESH_DATA : register(b1, space0)
 {
+    float3 positionOffset;
     unsigned int materialIndex;
+    float3 positionScale;
     unsigned int transformIndexStart;
 };
 
@@ -22,12 +22,22 @@ cbuffer SCENE_DATA : register(b0, space0)
 
 cbuffer MESH_DATA : register(b1, space0)
 {
+    float3 positionOffset;
     unsigned int materialIndex;
+    float3 positionScale;
     unsigned int transformIndexStart;
 };
 
 StructuredBuffer<matrix> transforms : register(t0, space0);
 
+#ifdef VISIBLE_TRANSFORMS
+// culled draws only cover the visible instances, this frame's list of them is filled by LevelDraw::Record
+StructuredBuffer<uint> visibleTransforms : register(t1, space0);
+#define INSTANCE_TRANSFORM(instanceID) transforms[visibleTransforms[transformIndexStart + instanceID]]
+#else
+#define INSTANCE_TRANSFORM(instanceID) transforms[transformIndexStart + instanceID]
+#endif
+
 struct OutputToRasterizer
 {
     float4 posH : SV_POSITION;
@@ -35,17 +45,34 @@ struct OutputToRasterizer
     float3 normW : NORMAL;
 };
 
+#ifdef COMPACT_VERTICES
+// same math as H2B::OctDecode in VertexCompression.h
+float3 OctDecode(float2 oct)
+{
+    float3 n = float3(oct, 1 - abs(oct.x) - abs(oct.y));
+    float t = saturate(-n.z);
+    n.xy += (n.xy >= 0) ? -t : t;
+    return normalize(n);
+}
+
+OutputToRasterizer main(float4 compactPos : POSITION, float2 inputUV : UVW, float2 compactNorm : NORMAL, unsigned int instanceID : SV_InstanceID)
+{
+    float3 inputPos = positionOffset + compactPos.xyz * positionScale;
+    float3 inputNorm = OctDecode(compactNorm);
+#else
 OutputToRasterizer main(float3 inputPos : POSITION, float3 inputUVW : UVW, float3 inputNorm : NORMAL, unsigned int instanceID : SV_InstanceID)
 {
+#endif
     float4 outPosH = float4(inputPos, 1);
     float4 outPosW = float4(inputPos, 1);    
     float4 outNormW = float4(inputNorm, 0);
     
-    outPosH = mul(transforms[transformIndexStart + instanceID], outPosH);
+    matrix world = INSTANCE_TRANSFORM(instanceID);
+    outPosH = mul(world, outPosH);
     outPosH = mul(viewProjection, outPosH);
     
-    outPosW = mul(transforms[transformIndexStart + instanceID], outPosW);
-    outNormW = mul(transforms[transformIndexStart + instanceID], outNormW);
+    outPosW = mul(world, outPosW);
+    outNormW = mul(world, outNormW);
     
     OutputToRasterizer output = (OutputToRasterizer) 0;
     output.posH = outPosH;
@@ -13,7 +13,40 @@ bool Wing3D::DirX12RendererLogic::Init(std::shared_ptr<flecs::world> _game, std:
 {
     log.Create("renderLogs.txt");
     log.EnableConsoleLogging(true);
-    lvlData.LoadLevel("../Assets/GameLevel.txt", "../Assets/Models", log);
+    // optional level processing is driven by the game settings
+    std::shared_ptr<const GameConfig> readCfg = _gameConfig.lock();
+    levelDraw.compactVertices = readCfg->at("Renderer").at("compactVertices").as<bool>();
+    unsigned importOptions = Level_Data::IMPORT_DEFAULT;
+    if (levelDraw.compactVertices)
+        importOptions |= Level_Data::IMPORT_COMPACT_VERTICES;
+    if (readCfg->at("Renderer").at("weldVertices").as<bool>())
+        importOptions |= Level_Data::IMPORT_WELD_VERTICES;
+    lvlData.weldEpsilon = readCfg->at("Renderer").at("weldEpsilon").as<float>();
+    if (readCfg->at("Renderer").at("optimizeMeshes").as<bool>())
+        importOptions |= Level_Data::IMPORT_OPTIMIZE_MESHES;
+    levelDraw.packedIndices = readCfg->at("Renderer").at("indices16").as<bool>();
+    if (levelDraw.packedIndices)
+        importOptions |= Level_Data::IMPORT_16BIT_INDICES;
+    levelDraw.meshLods = readCfg->at("Renderer").at("lods").as<bool>();
+    if (levelDraw.meshLods)
+        importOptions |= Level_Data::IMPORT_LODS;
+    lvlData.lodRatio = readCfg->at("Renderer").at("lodRatio").as<float>();
+    levelDraw.lodPixelError = readCfg->at("Renderer").at("lodPixelError").as<float>();
+    levelDraw.mergeStatic = readCfg->at("Renderer").at("mergeStatic").as<bool>();
+    if (levelDraw.mergeStatic)
+        importOptions |= Level_Data::IMPORT_MERGE_STATIC;
+    lvlData.mergeInstanceLimit = readCfg->at("Renderer").at("mergeInstanceLimit").as<int>();
+    levelDraw.frustumCulling = readCfg->at("Renderer").at("frustumCulling").as<bool>();
+    levelDraw.occlusionCulling = levelDraw.frustumCulling && readCfg->at("Renderer").at("occlusionCulling").as<bool>();
+    levelDraw.sortDraws = readCfg->at("Renderer").at("sortDraws").as<bool>();
+    recordThreads = std::max(1, readCfg->at("Renderer").at("recordThreads").as<int>());
+    // models that haven't changed since the last import are pulled from the cache instead
+    if (readCfg->at("Renderer").at("modelCache").as<bool>())
+        lvlData.modelCacheFolder = "../Assets/ModelCache";
+    hotReload = readCfg->at("Renderer").at("hotReload").as<bool>();
+    // uses the baked package when it is up to date, otherwise imports and bakes it.
+    // runs in the background so the window stays responsive, drawing starts once it is swapped in
+    lvlData.LoadLevelAsync(levelPath, modelFolder, packagePath, log, importOptions);
 
     // save a handle to the ECS & game settings
     game = _game;
@@ -120,11 +153,10 @@ bool Wing3D::DirX12RendererLogic::SetupDrawcalls()
         GW::MATH::GMatrix::InverseF(cameraMatrix, viewMatrix);
 
         GW::MATH::GMatrix::ProjectionDirectXLHF(G_DEGREE_TO_RADIAN_F(65), aspectRatio, 0.1f, 100, projectionMatrix);
-        GW::MATH::GMatrix::MultiplyMatrixF(viewMatrix, projectionMatrix, sceneDataForGPU.viewProjection);
-        sceneDataForGPU.camPos = cameraMatrix.row4;
+        GW::MATH::GMatrix::MultiplyMatrixF(viewMatrix, projectionMatrix, levelDraw.sceneData.viewProjection);
+        levelDraw.sceneData.camPos = cameraMatrix.row4;
 
         PipelineHandles curHandles = GetCurrentPipelineHandles();
-        SetupPipeline(curHandles);
 
         D3D12_CPU_DESCRIPTOR_HANDLE rtv;
         D3D12_CPU_DESCRIPTOR_HANDLE dsv;
@@ -134,28 +166,32 @@ bool Wing3D::DirX12RendererLogic::SetupDrawcalls()
             curHandles.commandList->ClearRenderTargetView(rtv, backgroundColor, 0, nullptr);
             curHandles.commandList->ClearDepthStencilView(dsv, D3D12_CLEAR_FLAG_DEPTH, 1, 0, 0, nullptr);
         }
+        // nothing to draw until the background load has been swapped in
+        if (levelLoaded == false && UpdateLevelLoad() == false)
+        {
+            curHandles.commandList->Release();
+            return;
+        }
+        UpdateHotReload();
         UINT curFrame = 0;
         d3d.GetSwapChainBufferIndex(curFrame);
-        UpdateTransformsForGPU(curFrame);
-
-        curHandles.commandList->SetGraphicsRoot32BitConstants(0, 32, &sceneDataForGPU, 0);
-        curHandles.commandList->SetGraphicsRootShaderResourceView(2, transformStrdBuffer[curFrame]->GetGPUVirtualAddress());
-        curHandles.commandList->SetGraphicsRootShaderResourceView(3, materialStrdBuffer[curFrame]->GetGPUVirtualAddress());
-
-        for (int instance = 0; instance < lvlData.levelInstances.size(); instance++)
+        if (BeginUploadFrame(curFrame) == false)
+        {
+            curHandles.commandList->Release();
+            return;
+        }
+        SetupPipeline(curHandles);
+        unsigned screenHeight = 0;
+        window.GetClientHeight(screenHeight);
+        const float pixelsPerUnit = screenHeight / (2 * std::tan(G_DEGREE_TO_RADIAN_F(65) * 0.5f));
+        D3D12Commands commands(*this, curHandles.commandList);
+        if (recordThreads > 1)
         {
-            int model = lvlData.levelInstances[instance].modelIndex;
-            for (int mesh = lvlData.levelModels[model].meshStart;
-                mesh < lvlData.levelModels[model].meshStart + lvlData.levelModels[model].meshCount; mesh++)
-            {
-                meshDataForGPU.materialIndex = mesh;
-                meshDataForGPU.transformIndexStart = lvlData.levelInstances[instance].transformStart;
-                curHandles.commandList->SetGraphicsRoot32BitConstants(1, 2, &meshDataForGPU, 0);
-
-                curHandles.commandList->DrawIndexedInstanced(lvlData.levelMeshes[mesh].drawInfo.indexCount, lvlData.levelInstances[instance].transformCount,
-                    lvlData.levelModels[model].indexStart + lvlData.levelMeshes[mesh].drawInfo.indexOffset, lvlData.levelModels[model].vertexStart, 0);
-            }
+            D3D12Chunks chunks(*this, curHandles.commandList, curFrame);
+            levelDraw.RecordParallel(lvlData, commands, chunks, curFrame, pixelsPerUnit, recordThreads);
         }
+        else
+            levelDraw.Record(lvlData, commands, curFrame, pixelsPerUnit);
 
         curHandles.commandList->Release();
      });
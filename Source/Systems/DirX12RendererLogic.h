@@ -10,6 +10,9 @@
 #include "../GameConfig.h"
 //Game Data Utilities
 #include "../Utils/lvlData.h"
+#include "../Utils/LevelDraw.h"
+#include "../Utils/UploadRing.h"
+#include <chrono>
 
 namespace Wing3D
 {
@@ -30,46 +33,66 @@ namespace Wing3D
 		// what we need at a minimum to draw a triangle
 		D3D12_VERTEX_BUFFER_VIEW vertexView;
 		D3D12_INDEX_BUFFER_VIEW indexView;
+		// 16 bit models when levelDraw.packedIndices is set, indexView then only covers the 32 bit ones
+		D3D12_INDEX_BUFFER_VIEW indexView16;
 		Microsoft::WRL::ComPtr<ID3D12Resource> vertexBuffer;
 		Microsoft::WRL::ComPtr<ID3D12Resource> indexBuffer;
 		Microsoft::WRL::ComPtr<ID3D12RootSignature> rootSignature;
 		Microsoft::WRL::ComPtr<ID3D12PipelineState>	pipeline;
+		// merged static buckets, used when levelDraw.mergeStatic is set
+		D3D12_VERTEX_BUFFER_VIEW mergedVertexView;
+		D3D12_INDEX_BUFFER_VIEW mergedIndexView;
+		Microsoft::WRL::ComPtr<ID3D12Resource> mergedVertexBuffer;
+		Microsoft::WRL::ComPtr<ID3D12Resource> mergedIndexBuffer;
+		// lvlData loads in the background, its GPU resources exist once this is set
+		bool levelLoaded = false;
+		// last load progress shown in the window title
+		std::string loadingTitle;
+		// where the level comes from, also watched for changes when hotReload is set
+		static constexpr const char* levelPath = "../Assets/GameLevel.txt";
+		static constexpr const char* modelFolder = "../Assets/Models";
+		static constexpr const char* packagePath = "../Assets/GameLevel.lvl";
+		// re-applies edits to the level file or its models while running
+		bool hotReload = false;
+		std::chrono::steady_clock::time_point nextReloadCheck;
+		std::filesystem::file_time_type levelFileTime;
+		std::unordered_map<std::string, std::filesystem::file_time_type> modelFileTimes;
 
 		// View Matrix for homogeneous position
 		GW::MATH::GMATRIXF viewMatrix;
 		// Projection Matrix for homogeneous position
 		GW::MATH::GMATRIXF projectionMatrix;
 
-		// Struct of Scene Data for GPU
-		struct SCENE_DATA {
-			// Sun Light settings and Camera Position
-			GW::MATH::GVECTORF sunDirection, sunColor, sunAmbiet, camPos;
-			// Combined view and projection matrices for homogenization
-			GW::MATH::GMATRIXF viewProjection;
-		} sceneDataForGPU;
-
-		// Struct of Mesh Data for GPU
-		struct MESH_DATA {
-			// Indices for color and transform
-			unsigned materialIndex, transformIndexStart;
-		} meshDataForGPU;
-
 		// Background buffer clear color
 		float* backgroundColor;
 
-		// Vector of transforms to update/send to gpu
-		std::vector<GW::MATH::GMATRIXF> transformsForGPU;
-
 		// Number of buffers in the swapchain
 		UINT maxActiveFrames;
 
-		// All transforms in the level - GPU Resource
-		std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> transformStrdBuffer;
-		// All Materials in the level - GPU Resource
-		std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>>	materialStrdBuffer;
-
-		// Descriptor Heap for Structured Buffers
-		Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> descriptorHeap;
+		// Every frame's transforms, materials & visible transforms, mapped for as long as it lives - GPU Resource.
+		// Starts with one copy of the transforms per swapchain buffer, kept so only moved ones need writing.
+		Microsoft::WRL::ComPtr<ID3D12Resource> uploadBuffer;
+		UINT8* uploadMemory = nullptr;
+		size_t transformCopySize = 0;
+		// hands out the rest of uploadBuffer a frame at a time, reusing it once uploadFence says the GPU is done
+		UploadRing uploadRing;
+		size_t uploadRingStart = 0;
+		Microsoft::WRL::ComPtr<ID3D12Fence> uploadFence;
+		// frames are numbered from 1, uploadFence reaches a frame's number once its commands have run
+		unsigned long long uploadFrame = 0;
+		// where this frame's copy of each RenderCommands::BUFFER starts in uploadBuffer
+		size_t uploadOffsets[RenderCommands::BUFFER_COUNT] = {};
+
+		// A bundle and its allocator, the level's draw packets are recorded into several of these at once
+		struct RECORD_CHUNK
+		{
+			Microsoft::WRL::ComPtr<ID3D12CommandAllocator> allocator;
+			Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> bundle;
+		};
+		// chunks each frame can record into, grown when a frame needs more of them
+		std::vector<std::vector<RECORD_CHUNK>> recordChunks;
+		// most threads the level's draws are recorded on, 1 records them straight into the surface's command list
+		unsigned recordThreads = 1;
 
 		// *HARD CODED* sun settings
 		GW::MATH::GVECTORF sunLightDir = { -1, -1, 2 }, 
@@ -90,6 +113,8 @@ namespace Wing3D
 
 		// Data loaded in from blender
 		Level_Data lvlData;
+		// Draw settings, scene data & transforms, turns lvlData into each frame's commands
+		LevelDraw levelDraw;
 
 		GW::CORE::GEventReceiver shutdown;
 	public:
@@ -130,11 +155,8 @@ namespace Wing3D
 		void SetupPipeline(PipelineHandles handles)
 		{
 			handles.commandList->SetGraphicsRootSignature(rootSignature.Get());
-			handles.commandList->SetDescriptorHeaps(1, descriptorHeap.GetAddressOf());
 			handles.commandList->OMSetRenderTargets(1, &handles.renderTargetView, FALSE, &handles.depthStencilView);
 			handles.commandList->SetPipelineState(pipeline.Get());
-			handles.commandList->IASetVertexBuffers(0, 1, &vertexView);
-			handles.commandList->IASetIndexBuffer(&indexView);
 			handles.commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 		}
 
@@ -144,7 +166,7 @@ namespace Wing3D
 			D3D12_INPUT_ELEMENT_DESC formats[3];
 			formats[0].SemanticName = "POSITION";
 			formats[0].SemanticIndex = 0;
-			formats[0].Format = DXGI_FORMAT_R32G32B32_FLOAT;
+			formats[0].Format = levelDraw.compactVertices ? DXGI_FORMAT_R16G16B16A16_UNORM : DXGI_FORMAT_R32G32B32_FLOAT;
 			formats[0].InputSlot = 0;
 			formats[0].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
 			formats[0].InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA;
@@ -152,7 +174,7 @@ namespace Wing3D
 
 			formats[1].SemanticName = "UVW";
 			formats[1].SemanticIndex = 0;
-			formats[1].Format = DXGI_FORMAT_R32G32B32_FLOAT;
+			formats[1].Format = levelDraw.compactVertices ? DXGI_FORMAT_R16G16_FLOAT : DXGI_FORMAT_R32G32B32_FLOAT;
 			formats[1].InputSlot = 0;
 			formats[1].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
 			formats[1].InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA;
@@ -160,7 +182,7 @@ namespace Wing3D
 
 			formats[2].SemanticName = "NORMAL";
 			formats[2].SemanticIndex = 0;
-			formats[2].Format = DXGI_FORMAT_R32G32B32_FLOAT;
+			formats[2].Format = levelDraw.compactVertices ? DXGI_FORMAT_R16G16_SNORM : DXGI_FORMAT_R32G32B32_FLOAT;
 			formats[2].InputSlot = 0;
 			formats[2].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
 			formats[2].InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA;
@@ -189,15 +211,18 @@ namespace Wing3D
 		void CreateRootSignature(ID3D12Device* creator)
 		{
 			Microsoft::WRL::ComPtr<ID3DBlob> signature, errors;
-			CD3DX12_ROOT_PARAMETER rootParams[4] = {};
+			CD3DX12_ROOT_PARAMETER rootParams[5] = {};
 			CD3DX12_ROOT_SIGNATURE_DESC rootSignatureDesc;
 
 			rootParams[0].InitAsConstants(32, 0);
-			rootParams[1].InitAsConstants(2, 1);
+			rootParams[1].InitAsConstants(8, 1);
 			rootParams[2].InitAsShaderResourceView(0, 0, D3D12_SHADER_VISIBILITY_VERTEX);
 			rootParams[3].InitAsShaderResourceView(0, 0, D3D12_SHADER_VISIBILITY_PIXEL);
+			// visible transform list, only read by the vertex shader when culling
+			rootParams[4].InitAsShaderResourceView(1, 0, D3D12_SHADER_VISIBILITY_VERTEX);
+			UINT rootParamCount = levelDraw.frustumCulling ? 5 : 4;
 
-			rootSignatureDesc.Init(ARRAYSIZE(rootParams), rootParams, 0, nullptr, D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
+			rootSignatureDesc.Init(rootParamCount, rootParams, 0, nullptr, D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
 			D3D12SerializeRootSignature(&rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1, &signature, &errors);
 
 			creator->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&rootSignature));
@@ -260,10 +285,17 @@ namespace Wing3D
 			std::string vertexShaderSource = ReadFileIntoString("../Shaders/VertexShader.hlsl");
 
 			Microsoft::WRL::ComPtr<ID3DBlob> vsBlob, errors;
+			// selects the compact vertex decode and visible transform paths in the shader
+			D3D_SHADER_MACRO defines[3] = {};
+			int defineCount = 0;
+			if (levelDraw.compactVertices)
+				defines[defineCount++] = { "COMPACT_VERTICES", "1" };
+			if (levelDraw.frustumCulling)
+				defines[defineCount++] = { "VISIBLE_TRANSFORMS", "1" };
 
 			HRESULT compilationResult =
 				D3DCompile(vertexShaderSource.c_str(), vertexShaderSource.length(),
-					nullptr, nullptr, nullptr, "main", "vs_5_1", compilerFlags, 0,
+					nullptr, defines, nullptr, "main", "vs_5_1", compilerFlags, 0,
 					vsBlob.GetAddressOf(), errors.GetAddressOf());
 
 			if (FAILED(compilationResult))
@@ -288,90 +320,207 @@ namespace Wing3D
 			CreatePipelineState(vsBlob, psBlob, creator);
 		}
 
-		void InitializeStructuredBuffersAndViews(ID3D12Device* creator)
+		void InitializeGraphics()
 		{
-			CD3DX12_CPU_DESCRIPTOR_HANDLE handle = CD3DX12_CPU_DESCRIPTOR_HANDLE(descriptorHeap->GetCPUDescriptorHandleForHeapStart());
-			for (int i = 0; i < maxActiveFrames; i++)
-			{
-				unsigned structureBufferSize = sizeof(GW::MATH::GMATRIXF) * lvlData.levelTransforms.size();
-				creator->CreateCommittedResource( // using UPLOAD heap for simplicity
-					&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD), // DEFAULT recommend  
-					D3D12_HEAP_FLAG_NONE, &CD3DX12_RESOURCE_DESC::Buffer(structureBufferSize),
-					D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(transformStrdBuffer[i].GetAddressOf()));
+			ID3D12Device* creator;
+			d3d.GetDevice((void**)&creator);
 
-				UINT8* transferMemoryLocation;
-				transformStrdBuffer[i]->Map(0, &CD3DX12_RANGE(0, 0), reinterpret_cast<void**>(&transferMemoryLocation));
-				memcpy(transferMemoryLocation, lvlData.levelTransforms.data(), sizeof(GW::MATH::GMATRIXF) * lvlData.levelTransforms.size());
-				transformStrdBuffer[i]->Unmap(0, nullptr);
-
-				D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-				srvDesc.Buffer.NumElements = lvlData.levelTransforms.size();
-				srvDesc.Buffer.StructureByteStride = sizeof(GW::MATH::GMATRIXF);
-				srvDesc.Buffer.FirstElement = 0;
-				srvDesc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_NONE;
-				srvDesc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
-				srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-
-				creator->CreateShaderResourceView(transformStrdBuffer[i].Get(), &srvDesc, handle);
-				handle.Offset(1, sizeof(lvlData.levelTransforms));
+			recordChunks.resize(maxActiveFrames);
+			creator->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(uploadFence.ReleaseAndGetAddressOf()));
+
+			InitializeGraphicsPipeline(creator);
+
+			// free temporary handle
+			creator->Release();
+		}
+
+		// everything that depends on the level, created once the background load is swapped in
+		void InitializeLevelResources()
+		{
+			ID3D12Device* creator;
+			d3d.GetDevice((void**)&creator);
+			InitializeVertexBuffer(creator);
+			InitializeIndexBuffer(creator);
+			if (levelDraw.mergeStatic)
+				InitializeMergedBuffers(creator);
+
+			//Transform Init
+			levelDraw.Reset(lvlData);
+			InitializeUploadBuffer(creator);
+			// free temporary handle
+			creator->Release();
+		}
+
+		// bytes of each RenderCommands::BUFFER a frame uploads
+		size_t UploadSize(RenderCommands::BUFFER buffer)
+		{
+			if (buffer == RenderCommands::TRANSFORM_BUFFER)
+				return sizeof(GW::MATH::GMATRIXF) * levelDraw.transforms.size();
+			if (buffer == RenderCommands::MATERIAL_BUFFER)
+				return sizeof(H2B::ATTRIBUTES) * levelDraw.materials.size();
+			// every instance set transform at most once plus one per merged bucket
+			return levelDraw.frustumCulling ?
+				sizeof(unsigned) * (lvlData.levelTransforms.size() + lvlData.levelMergedBuckets.size() + 1) : 0;
+		}
+
+		void InitializeUploadBuffer(ID3D12Device* creator)
+		{
+			transformCopySize = AlignUpload(UploadSize(RenderCommands::TRANSFORM_BUFFER));
+			uploadRingStart = transformCopySize * maxActiveFrames;
+			size_t frameSize = 0;
+			for (unsigned buffer = RenderCommands::MATERIAL_BUFFER; buffer < RenderCommands::BUFFER_COUNT; buffer++)
+				frameSize += AlignUpload(UploadSize(static_cast<RenderCommands::BUFFER>(buffer)));
+			// every frame in flight plus the one being recorded
+			size_t ringSize = frameSize * (maxActiveFrames + 1);
+			creator->CreateCommittedResource(
+				&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+				D3D12_HEAP_FLAG_NONE, &CD3DX12_RESOURCE_DESC::Buffer(uploadRingStart + ringSize),
+				D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(uploadBuffer.ReleaseAndGetAddressOf()));
+			// upload heaps may stay mapped while the GPU reads them, it is only written never read back
+			uploadBuffer->Map(0, &CD3DX12_RANGE(0, 0), reinterpret_cast<void**>(&uploadMemory));
+			uploadRing.Reset(ringSize);
+		}
+
+		// root shader resource views need no more than this, it keeps every buffer on its own cache lines
+		static size_t AlignUpload(size_t size)
+		{
+			return (size + D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT - 1) & ~size_t(D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT - 1);
+		}
+
+		// Retires the frames the GPU has finished and takes this frame's buffers from the ring, the transforms
+		// use the swapchain buffer's own copy. Only waits on the GPU when the ring is full, returns false if
+		// there's still no room then.
+		bool BeginUploadFrame(unsigned frame)
+		{
+			if (uploadFrame > 0)
+			{
+				// the surface executed last frame's command list at EndFrame, so this signal lands right after it
+				ID3D12CommandQueue* queue;
+				d3d.GetCommandQueue((void**)&queue);
+				queue->Signal(uploadFence.Get(), uploadFrame);
+				queue->Release();
+				uploadRing.FinishFrame(uploadFrame);
+			}
+			uploadFrame++;
+			uploadRing.Retire(uploadFence->GetCompletedValue());
+			uploadOffsets[RenderCommands::TRANSFORM_BUFFER] = transformCopySize * frame;
+			for (unsigned buffer = RenderCommands::MATERIAL_BUFFER; buffer < RenderCommands::BUFFER_COUNT; buffer++)
+			{
+				size_t size = UploadSize(static_cast<RenderCommands::BUFFER>(buffer));
+				size_t offset = uploadRing.Allocate(size, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+				if (offset == UploadRing::INVALID_OFFSET && uploadFrame > 1)
+				{
+					uploadFence->SetEventOnCompletion(uploadFrame - 1, nullptr); // no event, waits right here
+					uploadRing.Retire(uploadFrame - 1);
+					offset = uploadRing.Allocate(size, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+				}
+				if (offset == UploadRing::INVALID_OFFSET)
+				{
+					log.LogCategorized("ERROR", "Upload ring is too small for a frame, skipping it.");
+					return false;
+				}
+				uploadOffsets[buffer] = uploadRingStart + offset;
 			}
+			return true;
+		}
 
-			for (int i = 0; i < maxActiveFrames; i++)
+		// Polls the background level load and shows its progress in the window title.
+		// Returns true once the level is in place and ready to draw.
+		bool UpdateLevelLoad()
+		{
+			static const char* stageNames[] = { "Starting", "Reading package", "Reading level", "Importing models",
+				"Resolving hierarchy", "Processing", "Saving package", "Complete", "Failed", "Canceled" };
+			std::string title = gameConfig.lock()->at("Window").at("title").as<std::string>();
+			if (lvlData.FinishLoad())
 			{
-				unsigned structureBufferSize = sizeof(H2B::ATTRIBUTES) * lvlData.levelMaterials.size();
-				creator->CreateCommittedResource(&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
-					D3D12_HEAP_FLAG_NONE, &CD3DX12_RESOURCE_DESC::Buffer(structureBufferSize),
-					D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(materialStrdBuffer[i].GetAddressOf()));
+				window.SetWindowName(title.c_str());
+				InitializeLevelResources();
+				levelLoaded = true;
+				if (hotReload)
+					FindChangedFiles(); // start watching from the files just loaded
+				return true;
+			}
+			Level_Data::LOAD_PROGRESS progress = lvlData.GetLoadProgress();
+			std::string status = title + " - " + stageNames[progress.stage];
+			if (progress.total > 0)
+				status += " " + std::to_string(progress.done) + "/" + std::to_string(progress.total);
+			if (status != loadingTitle)
+			{
+				window.SetWindowName(status.c_str());
+				loadingTitle = status;
+			}
+			return false;
+		}
 
-				UINT8* transferMemoryLocation;
-				materialStrdBuffer[i]->Map(0, &CD3DX12_RANGE(0, 0), reinterpret_cast<void**>(&transferMemoryLocation));
-				for (int j = 0; j < lvlData.levelMaterials.size(); j++)
+		// Names of the model files written since the last call, sets changedLevel if the level file was.
+		std::vector<std::string> FindChangedFiles(bool* changedLevel = nullptr)
+		{
+			std::vector<std::string> changed;
+			std::error_code error;
+			auto levelTime = std::filesystem::last_write_time(levelPath, error);
+			if (!error && levelTime != levelFileTime)
+			{
+				levelFileTime = levelTime;
+				if (changedLevel)
+					*changedLevel = true;
+			}
+			for (const auto& file : std::filesystem::directory_iterator(modelFolder, error))
+			{
+				auto modelTime = file.last_write_time(error);
+				if (error)
+					continue;
+				auto& knownTime = modelFileTimes[file.path().filename().string()];
+				if (knownTime != modelTime)
 				{
-					memcpy(transferMemoryLocation, &lvlData.levelMaterials[j].attrib, sizeof(H2B::ATTRIBUTES));
-					transferMemoryLocation += sizeof(H2B::ATTRIBUTES);
+					if (knownTime != std::filesystem::file_time_type())
+						changed.push_back(file.path().filename().string());
+					knownTime = modelTime;
 				}
-				materialStrdBuffer[i]->Unmap(0, nullptr);
-
-				D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-				srvDesc.Buffer.NumElements = lvlData.levelMaterials.size();
-				srvDesc.Buffer.StructureByteStride = sizeof(H2B::ATTRIBUTES);
-				srvDesc.Buffer.FirstElement = 0;
-				srvDesc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_NONE;
-				srvDesc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
-				srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-
-				creator->CreateShaderResourceView(materialStrdBuffer[i].Get(), &srvDesc, handle);
-				handle.Offset(1, sizeof(lvlData.levelMaterials));
 			}
+			return changed;
 		}
 
-		void InitializeDescriptorHeap(ID3D12Device* creator)
+		// Checks the level sources twice a second and applies any edits to the loaded level.
+		// Moved objects only patch levelDraw.transforms, anything else rebuilds the level's GPU resources.
+		void UpdateHotReload()
 		{
-			UINT numberOfStructuredBuffers = maxActiveFrames * 2;
-			UINT numberOfDescriptors = numberOfStructuredBuffers;
-
-			D3D12_DESCRIPTOR_HEAP_DESC cBufferHeapDesc = {};
-			cBufferHeapDesc.NumDescriptors = numberOfDescriptors;
-			cBufferHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-			cBufferHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-			creator->CreateDescriptorHeap(&cBufferHeapDesc, IID_PPV_ARGS(descriptorHeap.ReleaseAndGetAddressOf()));
+			auto now = std::chrono::steady_clock::now();
+			if (hotReload == false || now < nextReloadCheck)
+				return;
+			nextReloadCheck = now + std::chrono::milliseconds(500);
+			bool changedLevel = false;
+			std::vector<std::string> changedModels = FindChangedFiles(&changedLevel);
+			if (changedLevel == false && changedModels.empty())
+				return;
+			Level_Data::LEVEL_CHANGES changes;
+			if (lvlData.ReloadLevel(levelPath, modelFolder, log, changes, changedModels) == false)
+			{
+				log.LogCategorized("WARNING", "Hot reload failed, keeping the current level.");
+				return;
+			}
+			if (changes.rebuilt == false)
+			{
+				for (unsigned transform : changes.movedTransforms)
+					levelDraw.MoveTransform(lvlData, transform, lvlData.levelTransforms[transform]);
+				return;
+			}
+			WaitForGpu(); // frames in flight still read the old buffers
+			InitializeLevelResources();
 		}
 
-		void InitializeGraphics()
+		// Blocks until the GPU has finished all submitted work
+		void WaitForGpu()
 		{
 			ID3D12Device* creator;
 			d3d.GetDevice((void**)&creator);
-			InitializeVertexBuffer(creator);
-			InitializeIndexBuffer(creator);
-
-			transformStrdBuffer.resize(maxActiveFrames);
-			materialStrdBuffer.resize(maxActiveFrames);
-			InitializeDescriptorHeap(creator);
-			InitializeStructuredBuffersAndViews(creator);
-
-			InitializeGraphicsPipeline(creator);
-
-			// free temporary handle
+			ID3D12CommandQueue* queue;
+			d3d.GetCommandQueue((void**)&queue);
+			Microsoft::WRL::ComPtr<ID3D12Fence> fence;
+			creator->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(fence.GetAddressOf()));
+			queue->Signal(fence.Get(), 1);
+			fence->SetEventOnCompletion(1, nullptr); // no event, waits right here
+			// free temporary handles
+			queue->Release();
 			creator->Release();
 		}
 
@@ -392,6 +541,13 @@ namespace Wing3D
 
 		void InitializeVertexBuffer(ID3D12Device* creator)
 		{
+			if (levelDraw.compactVertices)
+			{
+				CreateVertexBuffer(creator, sizeof(H2B::COMPACT_VERTEX) * lvlData.levelCompactVertices.size());
+				WriteToVertexBuffer(lvlData.levelCompactVertices.data(), sizeof(H2B::COMPACT_VERTEX) * lvlData.levelCompactVertices.size());
+				CreateVertexView(sizeof(H2B::COMPACT_VERTEX), sizeof(H2B::COMPACT_VERTEX) * lvlData.levelCompactVertices.size());
+				return;
+			}
 			CreateVertexBuffer(creator, sizeof(H2B::VERTEX) * lvlData.levelVertices.size());
 			WriteToVertexBuffer(lvlData.levelVertices.data(), sizeof(H2B::VERTEX) * lvlData.levelVertices.size());
 			CreateVertexView(sizeof(H2B::VERTEX), sizeof(H2B::VERTEX) * lvlData.levelVertices.size());
@@ -422,17 +578,68 @@ namespace Wing3D
 
 		void InitializeIndexBuffer(ID3D12Device* creator)
 		{
+			if (levelDraw.packedIndices)
+			{
+				// one buffer, 16 bit indices first then the 32 bit ones at the next 4 byte boundary
+				unsigned int size16 = sizeof(unsigned short) * lvlData.levelIndices16.size();
+				unsigned int size32 = sizeof(unsigned) * lvlData.levelIndices32.size();
+				unsigned int offset32 = (size16 + 3) & ~3u;
+				CreateIndexBuffer(creator, (offset32 + size32 > 0) ? offset32 + size32 : 4);
+				UINT8* transferMemoryLocation;
+				indexBuffer->Map(0, &CD3DX12_RANGE(0, 0), reinterpret_cast<void**>(&transferMemoryLocation));
+				memcpy(transferMemoryLocation, lvlData.levelIndices16.data(), size16);
+				memcpy(transferMemoryLocation + offset32, lvlData.levelIndices32.data(), size32);
+				indexBuffer->Unmap(0, nullptr);
+				indexView16.BufferLocation = indexBuffer->GetGPUVirtualAddress();
+				indexView16.Format = DXGI_FORMAT_R16_UINT;
+				indexView16.SizeInBytes = size16;
+				indexView.BufferLocation = indexBuffer->GetGPUVirtualAddress() + offset32;
+				indexView.Format = DXGI_FORMAT_R32_UINT;
+				indexView.SizeInBytes = size32;
+				return;
+			}
 			CreateIndexBuffer(creator, sizeof(unsigned) * lvlData.levelIndices.size());
 			WriteToIndexBuffer(lvlData.levelIndices.data(), sizeof(unsigned) * lvlData.levelIndices.size());
 			CreateIndexView(sizeof(unsigned) * lvlData.levelIndices.size());
 		}
 
+		// vertices & indices of the merged static buckets, in the same vertex format as everything else
+		void InitializeMergedBuffers(ID3D12Device* creator)
+		{
+			const void* vertices = levelDraw.compactVertices ? (const void*)lvlData.levelMergedCompactVertices.data() :
+				(const void*)lvlData.levelMergedVertices.data();
+			unsigned int stride = levelDraw.compactVertices ? sizeof(H2B::COMPACT_VERTEX) : sizeof(H2B::VERTEX);
+			unsigned int vertexSize = stride * lvlData.levelMergedVertices.size();
+			unsigned int indexSize = sizeof(unsigned) * lvlData.levelMergedIndices.size();
+			creator->CreateCommittedResource(
+				&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+				D3D12_HEAP_FLAG_NONE, &CD3DX12_RESOURCE_DESC::Buffer(vertexSize > 0 ? vertexSize : stride),
+				D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(mergedVertexBuffer.ReleaseAndGetAddressOf()));
+			creator->CreateCommittedResource(
+				&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+				D3D12_HEAP_FLAG_NONE, &CD3DX12_RESOURCE_DESC::Buffer(indexSize > 0 ? indexSize : 4),
+				D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(mergedIndexBuffer.ReleaseAndGetAddressOf()));
+			UINT8* transferMemoryLocation;
+			mergedVertexBuffer->Map(0, &CD3DX12_RANGE(0, 0), reinterpret_cast<void**>(&transferMemoryLocation));
+			memcpy(transferMemoryLocation, vertices, vertexSize);
+			mergedVertexBuffer->Unmap(0, nullptr);
+			mergedIndexBuffer->Map(0, &CD3DX12_RANGE(0, 0), reinterpret_cast<void**>(&transferMemoryLocation));
+			memcpy(transferMemoryLocation, lvlData.levelMergedIndices.data(), indexSize);
+			mergedIndexBuffer->Unmap(0, nullptr);
+			mergedVertexView.BufferLocation = mergedVertexBuffer->GetGPUVirtualAddress();
+			mergedVertexView.StrideInBytes = stride;
+			mergedVertexView.SizeInBytes = vertexSize;
+			mergedIndexView.BufferLocation = mergedIndexBuffer->GetGPUVirtualAddress();
+			mergedIndexView.Format = DXGI_FORMAT_R32_UINT;
+			mergedIndexView.SizeInBytes = indexSize;
+		}
+
 		void CreateIndexBuffer(ID3D12Device* creator, unsigned int sizeInBytes)
 		{
 			creator->CreateCommittedResource(
 				&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
 				D3D12_HEAP_FLAG_NONE, &CD3DX12_RESOURCE_DESC::Buffer(sizeInBytes),
-				D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(indexBuffer.GetAddressOf()));
+				D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(indexBuffer.ReleaseAndGetAddressOf()));
 		}
 
 		void WriteToIndexBuffer(const void* dataToWrite, unsigned int sizeInBytes)
@@ -453,25 +660,114 @@ namespace Wing3D
 		void InitializeSceneDataForGPU()
 		{
 			//Scene Variables that currently Don't change throughout the program
-			sceneDataForGPU.sunColor = sunLightColor;
-			sceneDataForGPU.sunDirection = sunLightDir;
-			sceneDataForGPU.sunAmbiet = sunLightAmbient;
+			levelDraw.sceneData.sunColor = sunLightColor;
+			levelDraw.sceneData.sunDirection = sunLightDir;
+			levelDraw.sceneData.sunAmbiet = sunLightAmbient;
+		}
 
-			//Transform Init
-			for (int i = 0; i < lvlData.levelTransforms.size(); i++)
+		// LevelDraw's commands recorded straight into a D3D12 command list
+		class D3D12Commands : public RenderCommands
+		{
+			DirX12RendererLogic& renderer;
+			ID3D12GraphicsCommandList* commandList;
+			// skips rebinding buffers that are already bound
+			const D3D12_VERTEX_BUFFER_VIEW* boundVertices = nullptr;
+			const D3D12_INDEX_BUFFER_VIEW* boundIndices = nullptr;
+		public:
+			D3D12Commands(DirX12RendererLogic& _renderer, ID3D12GraphicsCommandList* _commandList)
+				: renderer(_renderer), commandList(_commandList) {}
+
+			// frame isn't needed, BeginUploadFrame already found this frame's copies
+			void WriteBuffer(BUFFER buffer, unsigned frame, unsigned offset, const void* data, unsigned size) override
 			{
-				transformsForGPU.push_back(lvlData.levelTransforms[i]);
+				memcpy(renderer.uploadMemory + renderer.uploadOffsets[buffer] + offset, data, size);
 			}
-		}
+			void SetShaderResource(unsigned parameter, BUFFER buffer, unsigned frame) override
+			{
+				commandList->SetGraphicsRootShaderResourceView(parameter,
+					renderer.uploadBuffer->GetGPUVirtualAddress() + renderer.uploadOffsets[buffer]);
+			}
+			void SetRootConstants(unsigned parameter, unsigned count, const void* data, unsigned offset) override
+			{
+				commandList->SetGraphicsRoot32BitConstants(parameter, count, data, offset);
+			}
+			void SetGeometry(GEOMETRY geometry) override
+			{
+				const D3D12_VERTEX_BUFFER_VIEW* vertices = geometry == MERGED_GEOMETRY ?
+					&renderer.mergedVertexView : &renderer.vertexView;
+				const D3D12_INDEX_BUFFER_VIEW* indices = geometry == MERGED_GEOMETRY ? &renderer.mergedIndexView :
+					geometry == LEVEL_GEOMETRY_16BIT ? &renderer.indexView16 : &renderer.indexView;
+				if (vertices != boundVertices)
+					commandList->IASetVertexBuffers(0, 1, vertices);
+				if (indices != boundIndices)
+					commandList->IASetIndexBuffer(indices);
+				boundVertices = vertices;
+				boundIndices = indices;
+			}
+			void DrawIndexedInstanced(unsigned indexCount, unsigned instanceCount,
+				unsigned startIndex, int baseVertex, unsigned startInstance) override
+			{
+				commandList->DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+			}
+		};
 
-		void UpdateTransformsForGPU(int curFrameBufferIndex)
+		// Records each chunk into a bundle from the frame's pool and executes them in order on the surface's
+		// command list. The surface only submits its list at EndFrame, after the clears recorded into it,
+		// so the chunks run inside it as bundles rather than as command lists of their own.
+		// The surface waits for the GPU before handing a frame back, so its bundles are free to reset by then.
+		class D3D12Chunks : public ParallelRenderCommands
 		{
-			UINT8* transferMemoryLocation = nullptr;
-			transformStrdBuffer[curFrameBufferIndex]->Map(0, &CD3DX12_RANGE(0, 0), reinterpret_cast<void**>(&transferMemoryLocation));
-			memcpy(transferMemoryLocation, transformsForGPU.data(), sizeof(GW::MATH::GMATRIXF) * transformsForGPU.size());
-			transformStrdBuffer[curFrameBufferIndex]->Unmap(0, nullptr);
+			DirX12RendererLogic& renderer;
+			ID3D12GraphicsCommandList* commandList;
+			std::vector<RECORD_CHUNK>& pool;
+			std::vector<D3D12Commands> chunks;
+		public:
+			D3D12Chunks(DirX12RendererLogic& _renderer, ID3D12GraphicsCommandList* _commandList, unsigned frame)
+				: renderer(_renderer), commandList(_commandList), pool(_renderer.recordChunks[frame]) {}
 
-		}
+			void BeginChunks(unsigned count) override
+			{
+				if (pool.size() < count)
+				{
+					ID3D12Device* creator;
+					renderer.d3d.GetDevice((void**)&creator);
+					for (size_t i = pool.size(); i < count; i++)
+					{
+						RECORD_CHUNK chunk;
+						creator->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_BUNDLE, IID_PPV_ARGS(&chunk.allocator));
+						creator->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_BUNDLE, chunk.allocator.Get(),
+							renderer.pipeline.Get(), IID_PPV_ARGS(&chunk.bundle));
+						chunk.bundle->Close(); // reset below like the others
+						pool.push_back(chunk);
+					}
+					// free temporary handle
+					creator->Release();
+				}
+				chunks.clear();
+				chunks.reserve(count);
+				for (unsigned i = 0; i < count; i++)
+				{
+					pool[i].allocator->Reset();
+					pool[i].bundle->Reset(pool[i].allocator.Get(), renderer.pipeline.Get());
+					// bundles inherit neither of these from the list executing them
+					pool[i].bundle->SetGraphicsRootSignature(renderer.rootSignature.Get());
+					pool[i].bundle->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+					chunks.emplace_back(renderer, pool[i].bundle.Get());
+				}
+			}
+			RenderCommands& Chunk(unsigned index) override
+			{
+				return chunks[index];
+			}
+			void SubmitChunks() override
+			{
+				for (size_t i = 0; i < chunks.size(); i++)
+				{
+					pool[i].bundle->Close();
+					commandList->ExecuteBundle(pool[i].bundle.Get());
+				}
+			}
+		};
 
 		bool SetupDrawcalls();
 	};	
@@ -0,0 +1,140 @@
+#ifndef _FRUSTUMCULLING_H_
+#define _FRUSTUMCULLING_H_
+#include <vector>
+#include <cmath>
+#include "h2bParser.h"
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__)
+#include <immintrin.h>
+#define FRUSTUM_CULLING_SSE 1
+// only when the compiler targets AVX, see the WING3D_AVX option in CMakeLists.txt
+#if defined(__AVX__)
+#define FRUSTUM_CULLING_AVX 1
+#endif
+#endif
+
+// Six planes facing inwards (left, right, bottom, top, near, far) with unit length normals,
+// a point p is inside a plane when x * p.x + y * p.y + z * p.z + w >= 0
+struct FRUSTUM {
+	GW::MATH::GVECTORF planes[6];
+};
+
+// Planes of a DirectX style (row vector, 0 <= z <= w) view projection matrix, in world space
+inline FRUSTUM ExtractFrustum(const GW::MATH::GMATRIXF& viewProjection)
+{
+	const GW::MATH::GMATRIXF& m = viewProjection;
+	// clip space coordinate i of a point is the dot product with column i
+	auto column = [&m](int i) {
+		return GW::MATH::GVECTORF{ m.row1.data[i], m.row2.data[i], m.row3.data[i], m.row4.data[i] };
+	};
+	auto add = [](GW::MATH::GVECTORF a, GW::MATH::GVECTORF b, float sign) {
+		return GW::MATH::GVECTORF{ a.x + b.x * sign, a.y + b.y * sign, a.z + b.z * sign, a.w + b.w * sign };
+	};
+	GW::MATH::GVECTORF x = column(0), y = column(1), z = column(2), w = column(3);
+	FRUSTUM out = { { add(w, x, 1), add(w, x, -1), add(w, y, 1), add(w, y, -1), z, add(w, z, -1) } };
+	for (GW::MATH::GVECTORF& plane : out.planes) {
+		float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+		if (length > 0)
+			plane = { plane.x / length, plane.y / length, plane.z / length, plane.w / length };
+	}
+	return out;
+}
+
+// World space bounding spheres stored SoA so they can be tested several at a time
+struct CULL_SPHERES {
+	std::vector<float> x, y, z, radius;
+
+	void resize(size_t count, float defaultRadius)
+	{
+		x.assign(count, 0); y.assign(count, 0); z.assign(count, 0);
+		radius.assign(count, defaultRadius);
+	}
+	// sphere around the model space one (center, radius) once world is applied to it
+	void Set(unsigned i, const H2B::VECTOR& center, float modelRadius, const GW::MATH::GMATRIXF& world)
+	{
+		x[i] = center.x * world.row1.x + center.y * world.row2.x + center.z * world.row3.x + world.row4.x;
+		y[i] = center.x * world.row1.y + center.y * world.row2.y + center.z * world.row3.y + world.row4.y;
+		z[i] = center.x * world.row1.z + center.y * world.row2.z + center.z * world.row3.z + world.row4.z;
+		float scale = std::fmax(std::fmax(
+			world.row1.x * world.row1.x + world.row1.y * world.row1.y + world.row1.z * world.row1.z,
+			world.row2.x * world.row2.x + world.row2.y * world.row2.y + world.row2.z * world.row2.z),
+			world.row3.x * world.row3.x + world.row3.y * world.row3.y + world.row3.z * world.row3.z);
+		radius[i] = modelRadius * std::sqrt(scale);
+	}
+};
+
+// Reference version. Writes the index of every sphere in [start, start + count) that touches the
+// frustum to visible and returns how many there were.
+inline unsigned CullSpheresScalar(const FRUSTUM& frustum, const CULL_SPHERES& spheres,
+	unsigned start, unsigned count, unsigned* visible)
+{
+	unsigned visibleCount = 0;
+	for (unsigned i = start; i < start + count; ++i) {
+		bool inside = true;
+		for (const GW::MATH::GVECTORF& plane : frustum.planes)
+			inside &= plane.x * spheres.x[i] + plane.y * spheres.y[i] + plane.z * spheres.z[i] + plane.w >= -spheres.radius[i];
+		visible[visibleCount] = i;
+		visibleCount += inside;
+	}
+	return visibleCount;
+}
+
+// Same result as CullSpheresScalar, 8 (AVX) or 4 (SSE) spheres at a time.
+// Every sphere is written to visible before deciding whether to keep it,
+// so visible needs room for count + 8 indices even when few survive.
+inline unsigned CullSpheres(const FRUSTUM& frustum, const CULL_SPHERES& spheres,
+	unsigned start, unsigned count, unsigned* visible)
+{
+	unsigned visibleCount = 0, i = start;
+	const unsigned end = start + count;
+#ifdef FRUSTUM_CULLING_AVX
+	__m256 planeX[6], planeY[6], planeZ[6], planeW[6];
+	for (int p = 0; p < 6; ++p) {
+		planeX[p] = _mm256_set1_ps(frustum.planes[p].x); planeY[p] = _mm256_set1_ps(frustum.planes[p].y);
+		planeZ[p] = _mm256_set1_ps(frustum.planes[p].z); planeW[p] = _mm256_set1_ps(frustum.planes[p].w);
+	}
+	for (; i + 8 <= end; i += 8) {
+		__m256 x = _mm256_loadu_ps(&spheres.x[i]), y = _mm256_loadu_ps(&spheres.y[i]);
+		__m256 z = _mm256_loadu_ps(&spheres.z[i]);
+		__m256 negRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&spheres.radius[i]));
+		__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (int p = 0; p < 6; ++p) {
+			__m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(
+				_mm256_mul_ps(planeX[p], x), _mm256_mul_ps(planeY[p], y)), _mm256_mul_ps(planeZ[p], z)), planeW[p]);
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negRadius, _CMP_GE_OQ));
+		}
+		unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(inside));
+		if (mask == 0)
+			continue; // the usual case when most of the level is off screen
+		for (unsigned lane = 0; lane < 8; ++lane) {
+			visible[visibleCount] = i + lane;
+			visibleCount += (mask >> lane) & 1;
+		}
+	}
+#endif
+#ifdef FRUSTUM_CULLING_SSE
+	__m128 planeX4[6], planeY4[6], planeZ4[6], planeW4[6];
+	for (int p = 0; p < 6; ++p) {
+		planeX4[p] = _mm_set1_ps(frustum.planes[p].x); planeY4[p] = _mm_set1_ps(frustum.planes[p].y);
+		planeZ4[p] = _mm_set1_ps(frustum.planes[p].z); planeW4[p] = _mm_set1_ps(frustum.planes[p].w);
+	}
+	for (; i + 4 <= end; i += 4) {
+		__m128 x = _mm_loadu_ps(&spheres.x[i]), y = _mm_loadu_ps(&spheres.y[i]), z = _mm_loadu_ps(&spheres.z[i]);
+		__m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&spheres.radius[i]));
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int p = 0; p < 6; ++p) {
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(planeX4[p], x), _mm_mul_ps(planeY4[p], y)), _mm_mul_ps(planeZ4[p], z)), planeW4[p]);
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negRadius));
+		}
+		unsigned mask = static_cast<unsigned>(_mm_movemask_ps(inside));
+		if (mask == 0)
+			continue; // the usual case when most of the level is off screen
+		for (unsigned lane = 0; lane < 4; ++lane) {
+			visible[visibleCount] = i + lane;
+			visibleCount += (mask >> lane) & 1;
+		}
+	}
+#endif
+	return visibleCount + CullSpheresScalar(frustum, spheres, i, end - i, visible + visibleCount);
+}
+#endif
@@ -0,0 +1,30 @@
+#ifndef _INDEXPACKING_H_
+#define _INDEXPACKING_H_
+#include <vector>
+
+namespace H2B {
+
+	// where one model's indices ended up once they are split by index format
+	struct PACKED_INDICES {
+		unsigned start; // first index in the array picked by wide
+		unsigned wide; // 0 for 16 bit indices, 1 for 32 bit indices
+	};
+	// Appends a model's indices (relative to its own vertices) to the narrowest array that can hold them
+	inline PACKED_INDICES PackIndices(const unsigned* indices, unsigned indexCount,
+		std::vector<unsigned short>& outIndices16, std::vector<unsigned>& outIndices32)
+	{
+		unsigned largest = 0;
+		for (unsigned i = 0; i < indexCount; ++i)
+			largest = (indices[i] > largest) ? indices[i] : largest;
+		if (largest <= 0xFFFF) {
+			PACKED_INDICES out = { static_cast<unsigned>(outIndices16.size()), 0 };
+			for (unsigned i = 0; i < indexCount; ++i)
+				outIndices16.push_back(static_cast<unsigned short>(indices[i]));
+			return out;
+		}
+		PACKED_INDICES out = { static_cast<unsigned>(outIndices32.size()), 1 };
+		outIndices32.insert(outIndices32.end(), indices, indices + indexCount);
+		return out;
+	}
+}
+#endif
@@ -0,0 +1,555 @@
+#ifndef _LEVELDRAW_H_
+#define _LEVELDRAW_H_
+#include "lvlData.h"
+#include "RenderCommands.h"
+#include "FrustumCulling.h"
+#include "OcclusionCulling.h"
+#include "RadixSort.h"
+#include "ParallelFor.h"
+#include <cfloat>
+#include <algorithm>
+
+// Builds the commands that draw a loaded level for one frame. Nothing here touches the GPU,
+// so the same frame can be submitted to D3D12 or recorded headlessly.
+class LevelDraw
+{
+public:
+	// Struct of Scene Data for GPU, root constants 0
+	struct SCENE_DATA {
+		// Sun Light settings and Camera Position
+		GW::MATH::GVECTORF sunDirection, sunColor, sunAmbiet, camPos;
+		// Combined view and projection matrices for homogenization
+		GW::MATH::GMATRIXF viewProjection;
+	} sceneData;
+
+	// Struct of Mesh Data for GPU, root constants 1 (ordered to match HLSL cbuffer packing)
+	struct MESH_DATA {
+		// Expands compact vertex positions, ignored for full precision vertices
+		H2B::VECTOR positionOffset;
+		// Index for color
+		unsigned materialIndex;
+		H2B::VECTOR positionScale;
+		// Index for transform
+		unsigned transformIndexStart;
+	};
+	static_assert(sizeof(SCENE_DATA) == 32 * 4 && sizeof(MESH_DATA) == 8 * 4, "root constant sizes changed");
+
+	// draw with H2B::COMPACT_VERTEX data and each model's quantization
+	bool compactVertices = false;
+	// draw each model from 16 bit indices whenever its vertex range allows it
+	bool packedIndices = false;
+	// draw each instance set with the coarsest LOD that stays within lodPixelError pixels on screen
+	bool meshLods = false;
+	float lodPixelError = 1.0f;
+	// single instance models are drawn from the level's merged buckets, one draw per material
+	bool mergeStatic = false;
+	// instances outside the view are left out of their set's draw, the shader then finds
+	// each instance's transform through the visible list (VISIBLE_BUFFER, root SRV 4)
+	bool frustumCulling = false;
+	// submit draws in PacketKey order instead of level order
+	bool sortDraws = false;
+	// also leaves out instances hidden behind the biggest occluders in view, needs frustumCulling.
+	// merged buckets are drawn whole, only instance sets lose instances
+	bool occlusionCulling = false;
+
+	// Vector of transforms to update/send to gpu
+	std::vector<GW::MATH::GMATRIXF> transforms;
+	// the level's distinct materials in materialIndex order (MATERIAL_BUFFER)
+	std::vector<H2B::ATTRIBUTES> materials;
+
+	// call whenever level was loaded or rebuilt
+	void Reset(const Level_Data& level)
+	{
+		transforms.assign(level.levelTransforms.begin(), level.levelTransforms.end());
+		// every frame's copy is written in full the next time it's recorded
+		transformCopies.clear();
+		totalTransformUploadBytes = 0;
+		// meshes find theirs through levelMeshMaterials
+		materials.clear();
+		for (unsigned material : level.levelUniqueMaterials)
+			materials.push_back(level.levelMaterials[material].attrib);
+		modelLodErrors.clear();
+		if (meshLods)
+			InitializeModelLodErrors(level);
+		if (frustumCulling)
+		{
+			// transforms outside any instance set (merged bucket ones) are never tested
+			spheres.resize(transforms.size(), FLT_MAX);
+			transformModels.assign(transforms.size(), ~0u);
+			for (const Level_Data::MODEL_INSTANCES& instances : level.levelInstances)
+				for (unsigned i = instances.transformStart; i < instances.transformStart + instances.transformCount; i++)
+				{
+					transformModels[i] = instances.modelIndex;
+					MoveTransform(level, i, transforms[i]);
+				}
+			// every drawn transform at most once, plus one per bucket and room for CullSpheres to overshoot
+			visibleTransforms.resize(transforms.size() + level.levelMergedBuckets.size() + 8);
+			visibleStarts.resize(level.levelInstances.size());
+			visibleCounts.resize(level.levelInstances.size());
+		}
+		occluderTransforms.clear();
+		if (frustumCulling && occlusionCulling)
+		{
+			occlusion.Resize(OCCLUSION_SIZE, OCCLUSION_SIZE);
+			// a model's indexCount also holds its LODs, simplified copies may cover pixels the real mesh doesn't
+			occluderModelTriangles.assign(level.levelModels.size(), 0);
+			for (unsigned m = 0; m < level.levelModels.size(); m++)
+				for (unsigned i = 0; i < level.levelModels[m].meshCount; i++)
+					occluderModelTriangles[m] += level.levelMeshes[level.levelModels[m].meshStart + i].drawInfo.indexCount / 3;
+			// merged instances hide things just as well, they just can't be hidden themselves
+			for (const Level_Data::MODEL_INSTANCES& instances : level.levelInstances)
+				if (occluderModelTriangles[instances.modelIndex] <= OCCLUDER_MAX_TRIANGLES)
+					for (unsigned i = instances.transformStart; i < instances.transformStart + instances.transformCount; i++)
+						occluderTransforms.push_back(i);
+		}
+	}
+
+	// replaces one of the level's transforms, keeping its culling sphere in step
+	void MoveTransform(const Level_Data& level, unsigned transform, const GW::MATH::GMATRIXF& world)
+	{
+		transforms[transform] = world;
+		for (TRANSFORM_COPY& copy : transformCopies)
+			copy.dirty[transform / 64] |= 1ull << (transform % 64);
+		if (frustumCulling && transformModels[transform] != ~0u)
+		{
+			const H2B::BOUNDS& bounds = level.levelModelBounds[transformModels[transform]];
+			spheres.Set(transform, bounds.center, bounds.radius, world);
+		}
+	}
+
+	// number of transforms in VISIBLE_BUFFER after the last Record, culling only
+	unsigned VisibleCount() const { return visibleCount; }
+	// instances occlusionCulling left out and occluder triangles it drew during the last Record
+	unsigned OccludedCount() const { return occludedCount; }
+	unsigned OccluderTriangles() const { return occluderTriangles; }
+	// TRANSFORM_BUFFER bytes written by the last Record, and by every Record since Reset
+	size_t TransformUploadBytes() const { return transformUploadBytes; }
+	unsigned long long TotalTransformUploadBytes() const { return totalTransformUploadBytes; }
+
+	// pixelsPerUnit is how many pixels tall one unit looks at a distance of one unit
+	void Record(const Level_Data& level, RenderCommands& commands, unsigned frame, float pixelsPerUnit)
+	{
+		PrepareFrame(level, commands, frame, pixelsPerUnit);
+		BindFrame(commands, frame);
+		SubmitPackets(commands, 0, static_cast<unsigned>(packetOrder.size()));
+	}
+
+	// fewest packets worth a chunk of their own in RecordParallel
+	static constexpr unsigned MIN_CHUNK_PACKETS = 64;
+
+	// Same draws as Record, with the buffer writes going to commands and the packets split into up
+	// to maxChunks runs recorded on the thread pool. Chunks start with nothing bound, so each binds the frame again.
+	void RecordParallel(const Level_Data& level, RenderCommands& commands, ParallelRenderCommands& chunks,
+		unsigned frame, float pixelsPerUnit, unsigned maxChunks)
+	{
+		PrepareFrame(level, commands, frame, pixelsPerUnit);
+		const unsigned packetCount = static_cast<unsigned>(packetOrder.size());
+		const unsigned chunkCount = std::max(1u, std::min(maxChunks, packetCount / MIN_CHUNK_PACKETS));
+		chunks.BeginChunks(chunkCount);
+		ParallelFor(chunkCount, [&](unsigned chunk) {
+			RenderCommands& chunkCommands = chunks.Chunk(chunk);
+			BindFrame(chunkCommands, frame);
+			SubmitPackets(chunkCommands, packetCount * chunk / chunkCount, packetCount * (chunk + 1) / chunkCount);
+		});
+		chunks.SubmitChunks();
+	}
+
+	// when visible is set only its visibleInstances transforms are considered, otherwise the whole set
+	unsigned SelectLod(const Level_Data::MODEL_INSTANCES& instances, float pixelsPerUnit,
+		const unsigned* visible = nullptr, unsigned visibleInstances = 0) const
+	{
+		return LodForScale(instances.modelIndex, ViewInstances(instances, pixelsPerUnit, visible, visibleInstances).errorScale);
+	}
+
+	// One draw and everything it needs. PacketKey orders them by, most significant first:
+	// geometry (2 bits), material (14 bits), model (24 bits) & camera distance (24 bits)
+	struct DRAW_PACKET {
+		RenderCommands::GEOMETRY geometry;
+		unsigned indexCount, instanceCount, startIndex;
+		int baseVertex;
+		MESH_DATA constants;
+	};
+
+	static unsigned long long PacketKey(RenderCommands::GEOMETRY geometry, unsigned material, unsigned model, float distance)
+	{
+		// positive floats order like their bits, the top 24 of the 31 left after the sign keep that
+		unsigned distanceBits;
+		distance = std::fmax(distance, 0.0f);
+		std::memcpy(&distanceBits, &distance, sizeof(distanceBits));
+		return (static_cast<unsigned long long>(geometry) << 62) |
+			(static_cast<unsigned long long>(material < 0x3FFF ? material : 0x3FFF) << 48) |
+			(static_cast<unsigned long long>(model & 0xFFFFFF) << 24) | (distanceBits >> 7);
+	}
+
+private:
+	// largest error of any mesh in a model at each LOD (model * Level_Data::LOD_COUNT + lod)
+	std::vector<float> modelLodErrors;
+	// world bounding sphere & model of every transform, for frustumCulling
+	CULL_SPHERES spheres;
+	std::vector<unsigned> transformModels;
+	// this frame's visible transforms, each set's run starts at visibleStarts[set]
+	std::vector<unsigned> visibleTransforms, visibleStarts, visibleCounts;
+	unsigned visibleCount = 0, bucketVisibleStart = 0;
+	// depth of this frame's occluders, OCCLUSION_SIZE pixels square across the whole view
+	static constexpr unsigned OCCLUSION_SIZE = 256;
+	// models with more triangles than this are never drawn as occluders
+	static constexpr unsigned OCCLUDER_MAX_TRIANGLES = 4096;
+	// occluders are drawn biggest first until this many triangles, those looking smaller than this are skipped.
+	// size is the bounding sphere's radius over its distance from the camera
+	static constexpr unsigned OCCLUDER_TRIANGLE_BUDGET = 16384;
+	static constexpr float OCCLUDER_MIN_SIZE = 0.1f;
+	OCCLUSION_BUFFER occlusion;
+	// transforms of every instance small enough to be an occluder
+	std::vector<unsigned> occluderTransforms;
+	// triangles each model draws as an occluder, LOD 0 of all its meshes
+	std::vector<unsigned> occluderModelTriangles;
+	// this frame's occluders in view, negated size & transform so they sort biggest first
+	std::vector<std::pair<float, unsigned>> occluders;
+	unsigned occludedCount = 0, occluderTriangles = 0;
+	// one bit per transform moved since that frame's copy of TRANSFORM_BUFFER was written
+	struct TRANSFORM_COPY {
+		std::vector<unsigned long long> dirty;
+		bool written = false; // a copy that was never written needs every transform
+	};
+	std::vector<TRANSFORM_COPY> transformCopies;
+	size_t transformUploadBytes = 0;
+	unsigned long long totalTransformUploadBytes = 0;
+	// moved transforms this close together are written as one range, clean ones in between included
+	static constexpr unsigned TRANSFORM_RANGE_GAP = 4;
+	// this frame's coalesced moved ranges, first & end transform of each
+	std::vector<unsigned> transformRanges;
+	// this frame's packets in level order, packetOrder is the order they are submitted in
+	std::vector<DRAW_PACKET> packets;
+	std::vector<SORT_KEY> packetOrder, sortScratch;
+
+	// distance to the closest of the considered instances and the most pixels a unit of error covers on any of them
+	struct SET_VIEW {
+		float nearest, errorScale;
+	};
+	SET_VIEW ViewInstances(const Level_Data::MODEL_INSTANCES& instances, float pixelsPerUnit,
+		const unsigned* visible, unsigned visibleInstances) const
+	{
+		SET_VIEW view = { FLT_MAX, 0 };
+		const unsigned count = visible ? visibleInstances : instances.transformCount;
+		for (unsigned i = 0; i < count; i++)
+		{
+			const GW::MATH::GMATRIXF& world = transforms[visible ? visible[i] : instances.transformStart + i];
+			float scale = std::fmax(std::fmax(
+				std::sqrt(world.row1.x * world.row1.x + world.row1.y * world.row1.y + world.row1.z * world.row1.z),
+				std::sqrt(world.row2.x * world.row2.x + world.row2.y * world.row2.y + world.row2.z * world.row2.z)),
+				std::sqrt(world.row3.x * world.row3.x + world.row3.y * world.row3.y + world.row3.z * world.row3.z));
+			float x = world.row4.x - sceneData.camPos.x;
+			float y = world.row4.y - sceneData.camPos.y;
+			float z = world.row4.z - sceneData.camPos.z;
+			float distance = std::fmax(std::sqrt(x * x + y * y + z * z), 0.1f); // no closer than the near plane
+			view.nearest = std::fmin(view.nearest, distance);
+			view.errorScale = std::fmax(view.errorScale, scale / distance * pixelsPerUnit);
+		}
+		return view;
+	}
+
+	// the closest instance decides for the whole set since they share one draw
+	unsigned LodForScale(unsigned model, float errorScale) const
+	{
+		const float* errors = &modelLodErrors[model * Level_Data::LOD_COUNT];
+		unsigned lod = 0;
+		while (lod + 1 < Level_Data::LOD_COUNT && errors[lod + 1] * errorScale <= lodPixelError)
+			lod++;
+		return lod;
+	}
+
+	// one packet per mesh of every drawn instance set, then one per merged bucket
+	void BuildPackets(const Level_Data& level, float pixelsPerUnit)
+	{
+		packets.clear();
+		packetOrder.clear();
+		DRAW_PACKET packet = {};
+		for (unsigned set = 0; set < level.levelInstances.size(); set++)
+		{
+			const Level_Data::MODEL_INSTANCES& instances = level.levelInstances[set];
+			if (instances.flags & Level_Data::INSTANCES_MERGED)
+				continue; // drawn with its material bucket below
+			unsigned transformStart = instances.transformStart, instanceCount = instances.transformCount;
+			if (frustumCulling)
+			{
+				transformStart = visibleStarts[set];
+				instanceCount = visibleCounts[set];
+				if (instanceCount == 0)
+					continue;
+			}
+			unsigned model = instances.modelIndex;
+			const Level_Data::LEVEL_MODEL& info = level.levelModels[model];
+			unsigned indexStart = info.indexStart;
+			packet.geometry = RenderCommands::LEVEL_GEOMETRY;
+			if (packedIndices)
+			{
+				if (level.levelPackedIndices[model].wide == false)
+					packet.geometry = RenderCommands::LEVEL_GEOMETRY_16BIT;
+				indexStart = level.levelPackedIndices[model].start;
+			}
+			SET_VIEW view = { 0, 0 };
+			if (meshLods || sortDraws)
+				view = ViewInstances(instances, pixelsPerUnit,
+					frustumCulling ? &visibleTransforms[transformStart] : nullptr, instanceCount);
+			unsigned lod = meshLods ? LodForScale(model, view.errorScale) : 0;
+			packet.instanceCount = instanceCount;
+			packet.baseVertex = info.vertexStart;
+			packet.constants.transformIndexStart = transformStart;
+			if (compactVertices)
+			{
+				packet.constants.positionOffset = level.levelQuantization[model].offset;
+				packet.constants.positionScale = level.levelQuantization[model].scale;
+			}
+			for (unsigned mesh = info.meshStart; mesh < info.meshStart + info.meshCount; mesh++)
+			{
+				H2B::BATCH drawInfo = level.levelMeshes[mesh].drawInfo;
+				if (meshLods)
+				{
+					const Level_Data::MESH_LOD& range = level.levelMeshLods[mesh * Level_Data::LOD_COUNT + lod];
+					drawInfo = { range.indexCount, range.indexOffset };
+				}
+				packet.indexCount = drawInfo.indexCount;
+				packet.startIndex = indexStart + drawInfo.indexOffset;
+				packet.constants.materialIndex = level.levelMeshMaterials[mesh];
+				AddPacket(packet, model, view.nearest);
+			}
+		}
+		if (mergeStatic == false)
+			return;
+		// buckets come after every model in the key, their objects are spread out so distance is left at 0
+		const unsigned bucketModels = static_cast<unsigned>(level.levelModels.size());
+		for (unsigned b = 0; b < level.levelMergedBuckets.size(); b++)
+		{
+			const Level_Data::MERGED_BUCKET& bucket = level.levelMergedBuckets[b];
+			packet.geometry = RenderCommands::MERGED_GEOMETRY;
+			packet.indexCount = bucket.indexCount;
+			packet.instanceCount = 1;
+			packet.startIndex = bucket.indexStart;
+			packet.baseVertex = bucket.vertexStart;
+			packet.constants.materialIndex = bucket.material;
+			packet.constants.transformIndexStart = frustumCulling ? bucketVisibleStart + b : bucket.transformIndex;
+			if (compactVertices)
+			{
+				packet.constants.positionOffset = bucket.quantization.offset;
+				packet.constants.positionScale = bucket.quantization.scale;
+			}
+			AddPacket(packet, bucketModels + b, 0);
+		}
+	}
+
+	void AddPacket(const DRAW_PACKET& packet, unsigned model, float distance)
+	{
+		if (sortDraws)
+			packetOrder.push_back({ PacketKey(packet.geometry, packet.constants.materialIndex, model, distance),
+				static_cast<unsigned>(packets.size()) });
+		else
+			packetOrder.push_back({ 0, static_cast<unsigned>(packets.size()) });
+		packets.push_back(packet);
+	}
+
+	// buffer uploads, culling and this frame's sorted packets
+	void PrepareFrame(const Level_Data& level, RenderCommands& commands, unsigned frame, float pixelsPerUnit)
+	{
+		UploadTransforms(commands, frame);
+		commands.WriteBuffer(RenderCommands::MATERIAL_BUFFER, frame, 0, materials.data(),
+			static_cast<unsigned>(sizeof(H2B::ATTRIBUTES) * materials.size()));
+		if (frustumCulling)
+			CullInstances(level, commands, frame);
+		BuildPackets(level, pixelsPerUnit);
+		if (sortDraws)
+			RadixSort(packetOrder, sortScratch);
+	}
+
+	// Brings frame's copy of TRANSFORM_BUFFER up to date. Only the ranges moved since it was last written
+	// are copied, unless it was never written or so much moved that one copy of everything is cheaper.
+	void UploadTransforms(RenderCommands& commands, unsigned frame)
+	{
+		const unsigned count = static_cast<unsigned>(transforms.size());
+		if (transformCopies.size() <= frame)
+			transformCopies.resize(frame + 1);
+		TRANSFORM_COPY& copy = transformCopies[frame];
+		copy.dirty.resize((count + 63) / 64);
+		transformRanges.clear();
+		unsigned rangeTransforms = 0;
+		for (unsigned word = 0; word < copy.dirty.size() && copy.written; word++)
+		{
+			unsigned long long bits = copy.dirty[word];
+			for (unsigned bit = 0; bits != 0; bit++, bits >>= 1)
+			{
+				if ((bits & 1) == 0)
+					continue;
+				unsigned transform = word * 64 + bit;
+				if (transformRanges.empty() == false && transform <= transformRanges.back() + TRANSFORM_RANGE_GAP)
+				{
+					rangeTransforms += transform + 1 - transformRanges.back();
+					transformRanges.back() = transform + 1;
+				}
+				else
+				{
+					transformRanges.push_back(transform);
+					transformRanges.push_back(transform + 1);
+					rangeTransforms++;
+				}
+			}
+		}
+		std::fill(copy.dirty.begin(), copy.dirty.end(), 0ull);
+		if (copy.written == false || rangeTransforms > count / 2)
+		{
+			transformRanges.assign({ 0, count });
+			copy.written = true;
+			rangeTransforms = count;
+		}
+		for (size_t range = 0; range < transformRanges.size(); range += 2)
+		{
+			const unsigned first = transformRanges[range], end = transformRanges[range + 1];
+			commands.WriteBuffer(RenderCommands::TRANSFORM_BUFFER, frame,
+				static_cast<unsigned>(sizeof(GW::MATH::GMATRIXF) * first), transforms.data() + first,
+				static_cast<unsigned>(sizeof(GW::MATH::GMATRIXF) * (end - first)));
+		}
+		transformUploadBytes = sizeof(GW::MATH::GMATRIXF) * rangeTransforms;
+		totalTransformUploadBytes += transformUploadBytes;
+	}
+
+	// what every run of packets expects to be bound before it starts
+	void BindFrame(RenderCommands& commands, unsigned frame) const
+	{
+		commands.SetGeometry(RenderCommands::LEVEL_GEOMETRY);
+		commands.SetRootConstants(0, 32, &sceneData, 0);
+		commands.SetShaderResource(2, RenderCommands::TRANSFORM_BUFFER, frame);
+		commands.SetShaderResource(3, RenderCommands::MATERIAL_BUFFER, frame);
+		if (frustumCulling)
+			commands.SetShaderResource(4, RenderCommands::VISIBLE_BUFFER, frame);
+	}
+
+	// draws packetOrder[begin, end), only rebinding geometry and resending the constants that changed
+	void SubmitPackets(RenderCommands& commands, unsigned begin, unsigned end) const
+	{
+		RenderCommands::GEOMETRY bound = RenderCommands::LEVEL_GEOMETRY; // bound by BindFrame
+		unsigned sent[8] = {};
+		bool anySent = false;
+		static_assert(sizeof(MESH_DATA) == sizeof(sent), "MESH_DATA is sent as 8 values");
+		for (unsigned i = begin; i < end; i++)
+		{
+			const DRAW_PACKET& packet = packets[packetOrder[i].index];
+			if (packet.geometry != bound)
+			{
+				commands.SetGeometry(packet.geometry);
+				bound = packet.geometry;
+			}
+			unsigned constants[8];
+			std::memcpy(constants, &packet.constants, sizeof(constants));
+			unsigned first = 0, last = 8;
+			if (anySent)
+			{
+				while (first < 8 && constants[first] == sent[first])
+					first++;
+				while (last > first && constants[last - 1] == sent[last - 1])
+					last--;
+			}
+			if (first < last)
+			{
+				commands.SetRootConstants(1, last - first, constants + first, first);
+				std::memcpy(sent + first, constants + first, sizeof(unsigned) * (last - first));
+				anySent = true;
+			}
+			commands.DrawIndexedInstanced(packet.indexCount, packet.instanceCount, packet.startIndex, packet.baseVertex, 0);
+		}
+	}
+
+	// fills the visible list for every instance set, then each bucket's transform, and uploads it
+	void CullInstances(const Level_Data& level, RenderCommands& commands, unsigned frame)
+	{
+		const FRUSTUM frustum = ExtractFrustum(sceneData.viewProjection);
+		occludedCount = 0;
+		if (occlusionCulling)
+			DrawOccluders(level, frustum);
+		visibleCount = 0;
+		for (unsigned set = 0; set < level.levelInstances.size(); set++)
+		{
+			const Level_Data::MODEL_INSTANCES& instances = level.levelInstances[set];
+			visibleStarts[set] = visibleCount;
+			visibleCounts[set] = 0;
+			if (instances.flags & Level_Data::INSTANCES_MERGED)
+				continue;
+			visibleCounts[set] = CullSpheres(frustum, spheres, instances.transformStart, instances.transformCount,
+				&visibleTransforms[visibleCount]);
+			if (occlusionCulling)
+				visibleCounts[set] = CullOccluded(level.levelModelBounds[instances.modelIndex],
+					&visibleTransforms[visibleCount], visibleCounts[set]);
+			visibleCount += visibleCounts[set];
+		}
+		bucketVisibleStart = visibleCount;
+		if (mergeStatic)
+			for (const Level_Data::MERGED_BUCKET& bucket : level.levelMergedBuckets)
+				visibleTransforms[visibleCount++] = bucket.transformIndex;
+		commands.WriteBuffer(RenderCommands::VISIBLE_BUFFER, frame, 0, visibleTransforms.data(),
+			static_cast<unsigned>(sizeof(unsigned) * visibleCount));
+	}
+
+	// draws the biggest occluders in view into occlusion
+	void DrawOccluders(const Level_Data& level, const FRUSTUM& frustum)
+	{
+		occluders.clear();
+		for (unsigned transform : occluderTransforms)
+		{
+			unsigned inside = 0;
+			if (CullSpheresScalar(frustum, spheres, transform, 1, &inside) == 0)
+				continue;
+			float x = spheres.x[transform] - sceneData.camPos.x;
+			float y = spheres.y[transform] - sceneData.camPos.y;
+			float z = spheres.z[transform] - sceneData.camPos.z;
+			float size = spheres.radius[transform] / std::fmax(std::sqrt(x * x + y * y + z * z), 0.1f);
+			if (size >= OCCLUDER_MIN_SIZE)
+				occluders.push_back({ -size, transform });
+		}
+		std::sort(occluders.begin(), occluders.end());
+		occlusion.Clear();
+		occluderTriangles = 0;
+		for (const std::pair<float, unsigned>& occluder : occluders)
+		{
+			const unsigned model = transformModels[occluder.second];
+			const Level_Data::LEVEL_MODEL& info = level.levelModels[model];
+			if (occluderTriangles + occluderModelTriangles[model] > OCCLUDER_TRIANGLE_BUDGET)
+				continue; // a smaller one may still fit
+			occluderTriangles += occluderModelTriangles[model];
+			GW::MATH::GMATRIXF worldViewProjection;
+			GW::MATH::GMatrix::MultiplyMatrixF(transforms[occluder.second], sceneData.viewProjection, worldViewProjection);
+			occlusion.PlaceVertices(&level.levelVertices[info.vertexStart], info.vertexCount, worldViewProjection);
+			for (unsigned i = info.meshStart; i < info.meshStart + info.meshCount; i++)
+				occlusion.DrawTriangles(&level.levelIndices[info.indexStart + level.levelMeshes[i].drawInfo.indexOffset],
+					level.levelMeshes[i].drawInfo.indexCount);
+		}
+		occlusion.Finish();
+	}
+
+	// keeps the count transforms in visible whose box isn't hidden in occlusion, returns how many that is
+	unsigned CullOccluded(const H2B::BOUNDS& bounds, unsigned* visible, unsigned count)
+	{
+		unsigned kept = 0;
+		for (unsigned i = 0; i < count; i++)
+		{
+			GW::MATH::GMATRIXF worldViewProjection;
+			GW::MATH::GMatrix::MultiplyMatrixF(transforms[visible[i]], sceneData.viewProjection, worldViewProjection);
+			visible[kept] = visible[i];
+			kept += occlusion.BoxVisible(bounds.min, bounds.max, worldViewProjection);
+		}
+		occludedCount += count - kept;
+		return kept;
+	}
+
+	void InitializeModelLodErrors(const Level_Data& level)
+	{
+		modelLodErrors.assign(level.levelModels.size() * Level_Data::LOD_COUNT, 0.0f);
+		for (unsigned model = 0; model < level.levelModels.size(); model++)
+		{
+			const Level_Data::LEVEL_MODEL& info = level.levelModels[model];
+			for (unsigned mesh = info.meshStart; mesh < info.meshStart + info.meshCount; mesh++)
+				for (unsigned lod = 0; lod < Level_Data::LOD_COUNT; lod++)
+				{
+					float& error = modelLodErrors[model * Level_Data::LOD_COUNT + lod];
+					error = std::fmax(error, level.levelMeshLods[mesh * Level_Data::LOD_COUNT + lod].error);
+				}
+		}
+	}
+};
+#endif
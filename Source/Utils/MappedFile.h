@@ -0,0 +1,108 @@
+#ifndef _MAPPEDFILE_H_
+#define _MAPPEDFILE_H_
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#include <utility>
+
+// Read-only view of an entire file on disk.
+// The OS pages the contents in on demand so nothing is copied or allocated up front.
+class MappedFile
+{
+	const unsigned char* view = nullptr;
+	size_t length = 0;
+#if defined(_WIN32)
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = nullptr;
+#endif
+public:
+	MappedFile() = default;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+	MappedFile& operator=(MappedFile&& other) noexcept
+	{
+		if (this != &other) {
+			Close();
+			std::swap(view, other.view);
+			std::swap(length, other.length);
+#if defined(_WIN32)
+			std::swap(file, other.file);
+			std::swap(mapping, other.mapping);
+#endif
+		}
+		return *this;
+	}
+	~MappedFile() { Close(); }
+
+	// maps the whole file, fails on missing or empty files
+	bool Open(const char* path)
+	{
+		Close();
+#if defined(_WIN32)
+		file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+		LARGE_INTEGER size;
+		if (GetFileSizeEx(file, &size) == FALSE || size.QuadPart == 0) {
+			Close();
+			return false;
+		}
+		mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping == nullptr) {
+			Close();
+			return false;
+		}
+		view = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+		if (view == nullptr) {
+			Close();
+			return false;
+		}
+		length = static_cast<size_t>(size.QuadPart);
+#else
+		int fd = open(path, O_RDONLY);
+		if (fd < 0)
+			return false;
+		struct stat info;
+		if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+			close(fd);
+			return false;
+		}
+		void* map = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd); // the mapping keeps its own reference to the file
+		if (map == MAP_FAILED)
+			return false;
+		view = static_cast<const unsigned char*>(map);
+		length = static_cast<size_t>(info.st_size);
+#endif
+		return true;
+	}
+	void Close()
+	{
+#if defined(_WIN32)
+		if (view != nullptr)
+			UnmapViewOfFile(view);
+		if (mapping != nullptr)
+			CloseHandle(mapping);
+		if (file != INVALID_HANDLE_VALUE)
+			CloseHandle(file);
+		mapping = nullptr;
+		file = INVALID_HANDLE_VALUE;
+#else
+		if (view != nullptr)
+			munmap(const_cast<unsigned char*>(view), length);
+#endif
+		view = nullptr;
+		length = 0;
+	}
+	bool IsOpen() const { return view != nullptr; }
+	const unsigned char* Data() const { return view; }
+	size_t Size() const { return length; }
+};
+#endif
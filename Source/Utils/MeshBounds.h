@@ -0,0 +1,118 @@
+#ifndef _MESHBOUNDS_H_
+#define _MESHBOUNDS_H_
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include "h2bParser.h"
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__)
+#include <xmmintrin.h>
+#define H2B_BOUNDS_SSE 1
+#endif
+
+namespace H2B {
+
+	// Axis aligned box and bounding sphere of a set of positions (model space)
+	struct BOUNDS {
+		VECTOR min, max;
+		VECTOR center; float radius; // sphere around the box center, only as big as the furthest point
+	};
+
+	// Reference version, walks one position at a time. position(i) returns the i'th of count positions.
+	template <typename POSITION>
+	inline BOUNDS ComputeBoundsScalar(unsigned count, POSITION position)
+	{
+		BOUNDS out = { { 0, 0, 0 }, { 0, 0, 0 }, { 0, 0, 0 }, 0 };
+		if (count == 0)
+			return out;
+		out.min = out.max = position(0);
+		for (unsigned i = 1; i < count; ++i) {
+			const VECTOR& p = position(i);
+			out.min = { std::fmin(out.min.x, p.x), std::fmin(out.min.y, p.y), std::fmin(out.min.z, p.z) };
+			out.max = { std::fmax(out.max.x, p.x), std::fmax(out.max.y, p.y), std::fmax(out.max.z, p.z) };
+		}
+		out.center = { (out.min.x + out.max.x) * 0.5f, (out.min.y + out.max.y) * 0.5f, (out.min.z + out.max.z) * 0.5f };
+		float radiusSq = 0;
+		for (unsigned i = 0; i < count; ++i) {
+			const VECTOR& p = position(i);
+			float x = p.x - out.center.x, y = p.y - out.center.y, z = p.z - out.center.z;
+			radiusSq = std::fmax(radiusSq, x * x + y * y + z * z);
+		}
+		out.radius = std::sqrt(radiusSq);
+		return out;
+	}
+
+	// Same result as ComputeBoundsScalar. With SSE, 4 positions are transposed into x, y & z lanes
+	// so every min, max and distance works on 4 positions at once.
+	template <typename POSITION>
+	inline BOUNDS ComputeBounds(unsigned count, POSITION position)
+	{
+#ifdef H2B_BOUNDS_SSE
+		if (count < 8)
+			return ComputeBoundsScalar(count, position);
+		// loads x, y, z plus one float past them, VECTOR is always followed by more data inside VERTEX
+		auto load4 = [&](unsigned i, __m128& x, __m128& y, __m128& z) {
+			__m128 p0 = _mm_loadu_ps(&position(i).x), p1 = _mm_loadu_ps(&position(i + 1).x);
+			__m128 p2 = _mm_loadu_ps(&position(i + 2).x), p3 = _mm_loadu_ps(&position(i + 3).x);
+			_MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+			x = p0; y = p1; z = p2;
+		};
+		auto horizontal = [](__m128 v, bool takeMax) {
+			v = takeMax ? _mm_max_ps(v, _mm_movehl_ps(v, v)) : _mm_min_ps(v, _mm_movehl_ps(v, v));
+			v = takeMax ? _mm_max_ss(v, _mm_shuffle_ps(v, v, 1)) : _mm_min_ss(v, _mm_shuffle_ps(v, v, 1));
+			return _mm_cvtss_f32(v);
+		};
+		const unsigned end = count & ~3u;
+		__m128 x, y, z;
+		load4(0, x, y, z);
+		__m128 minX = x, minY = y, minZ = z, maxX = x, maxY = y, maxZ = z;
+		for (unsigned i = 4; i < end; i += 4) {
+			load4(i, x, y, z);
+			minX = _mm_min_ps(minX, x); minY = _mm_min_ps(minY, y); minZ = _mm_min_ps(minZ, z);
+			maxX = _mm_max_ps(maxX, x); maxY = _mm_max_ps(maxY, y); maxZ = _mm_max_ps(maxZ, z);
+		}
+		BOUNDS out;
+		out.min = { horizontal(minX, false), horizontal(minY, false), horizontal(minZ, false) };
+		out.max = { horizontal(maxX, true), horizontal(maxY, true), horizontal(maxZ, true) };
+		for (unsigned i = end; i < count; ++i) {
+			const VECTOR& p = position(i);
+			out.min = { std::fmin(out.min.x, p.x), std::fmin(out.min.y, p.y), std::fmin(out.min.z, p.z) };
+			out.max = { std::fmax(out.max.x, p.x), std::fmax(out.max.y, p.y), std::fmax(out.max.z, p.z) };
+		}
+		out.center = { (out.min.x + out.max.x) * 0.5f, (out.min.y + out.max.y) * 0.5f, (out.min.z + out.max.z) * 0.5f };
+		const __m128 centerX = _mm_set1_ps(out.center.x), centerY = _mm_set1_ps(out.center.y),
+			centerZ = _mm_set1_ps(out.center.z);
+		__m128 radiusSq = _mm_setzero_ps();
+		for (unsigned i = 0; i < end; i += 4) {
+			load4(i, x, y, z);
+			x = _mm_sub_ps(x, centerX); y = _mm_sub_ps(y, centerY); z = _mm_sub_ps(z, centerZ);
+			radiusSq = _mm_max_ps(radiusSq,
+				_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+		}
+		float outRadiusSq = horizontal(radiusSq, true);
+		for (unsigned i = end; i < count; ++i) {
+			const VECTOR& p = position(i);
+			float dx = p.x - out.center.x, dy = p.y - out.center.y, dz = p.z - out.center.z;
+			outRadiusSq = std::fmax(outRadiusSq, dx * dx + dy * dy + dz * dz);
+		}
+		out.radius = std::sqrt(outRadiusSq);
+		return out;
+#else
+		return ComputeBoundsScalar(count, position);
+#endif
+	}
+	static_assert(offsetof(VERTEX, pos) + sizeof(float) * 4 <= sizeof(VERTEX),
+		"ComputeBounds reads one float past each position");
+
+	// bounds of a run of vertices
+	inline BOUNDS ComputeVertexBounds(const VERTEX* vertices, unsigned vertexCount)
+	{
+		return ComputeBounds(vertexCount, [vertices](unsigned i) -> const VECTOR& { return vertices[i].pos; });
+	}
+	// bounds of the vertices an index range draws, repeats don't matter
+	inline BOUNDS ComputeIndexedBounds(const unsigned* indices, unsigned indexCount, const VERTEX* vertices)
+	{
+		return ComputeBounds(indexCount,
+			[indices, vertices](unsigned i) -> const VECTOR& { return vertices[indices[i]].pos; });
+	}
+}
+#endif
@@ -0,0 +1,346 @@
+#ifndef _MESHOPTIMIZER_H_
+#define _MESHOPTIMIZER_H_
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include "h2bParser.h"
+
+namespace H2B {
+
+	// Results of running an index list through a simulated FIFO post-transform cache
+	struct VERTEX_CACHE_STATS {
+		unsigned transforms; // vertex shader invocations (cache misses)
+		unsigned vertices, triangles; // unique vertices referenced, triangles drawn
+		float acmr; // average cache miss ratio, transforms per triangle (0.5 is ideal for big grids)
+		float atvr; // average transform to vertex ratio, 1.0 means every vertex ran exactly once
+	};
+	// Simulates the GPU vertex reuse cache, indices are relative to a vertex range of vertexCount
+	inline VERTEX_CACHE_STATS AnalyzeVertexCache(const unsigned* indices, unsigned indexCount,
+		unsigned vertexCount, unsigned cacheSize = 16)
+	{
+		VERTEX_CACHE_STATS out = { 0, 0, indexCount / 3, 0, 0 };
+		// a vertex is cached while fewer than cacheSize misses happened since it was loaded
+		std::vector<unsigned> loadedAt(vertexCount, 0);
+		std::vector<char> used(vertexCount, 0);
+		for (unsigned i = 0; i < indexCount; ++i) {
+			unsigned v = indices[i];
+			if (v >= vertexCount)
+				continue;
+			used[v] = 1;
+			if (loadedAt[v] == 0 || out.transforms + 1 - loadedAt[v] > cacheSize)
+				loadedAt[v] = ++out.transforms;
+		}
+		out.vertices = static_cast<unsigned>(std::count(used.begin(), used.end(), 1));
+		if (out.triangles > 0)
+			out.acmr = out.transforms / static_cast<float>(out.triangles);
+		if (out.vertices > 0)
+			out.atvr = out.transforms / static_cast<float>(out.vertices);
+		return out;
+	}
+
+	// Reorders the triangles of one draw range for post-transform cache reuse.
+	// Tom Forsyth's "Linear-Speed Vertex Cache Optimisation", greedy and cache size independent.
+	inline void OptimizeVertexCache(unsigned* indices, unsigned indexCount, unsigned vertexCount)
+	{
+		const unsigned triangleCount = indexCount / 3;
+		if (triangleCount < 2)
+			return;
+		constexpr int cacheSize = 32;
+		auto vertexScore = [](int cachePosition, unsigned activeTriangles) {
+			if (activeTriangles == 0)
+				return -1.0f; // nothing left to draw with it
+			float score = 0.0f;
+			if (cachePosition >= 0) {
+				if (cachePosition < 3)
+					score = 0.75f; // used by the last triangle, fixed score avoids favoring any winding
+				else
+					score = std::pow(1.0f - (cachePosition - 3) * (1.0f / (cacheSize - 3)), 1.5f);
+			}
+			// boost vertices with few triangles left so they get finished instead of stranded
+			return score + 2.0f / std::sqrt(static_cast<float>(activeTriangles));
+		};
+		// vertex -> triangle adjacency
+		std::vector<unsigned> activeTriangles(vertexCount, 0);
+		for (unsigned i = 0; i < triangleCount * 3; ++i)
+			if (indices[i] < vertexCount)
+				++activeTriangles[indices[i]];
+			else
+				return; // out of range index, leave the data as exported
+		std::vector<unsigned> adjacencyStart(vertexCount + 1, 0);
+		for (unsigned v = 0; v < vertexCount; ++v)
+			adjacencyStart[v + 1] = adjacencyStart[v] + activeTriangles[v];
+		std::vector<unsigned> adjacency(triangleCount * 3);
+		std::vector<unsigned> fill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+		for (unsigned t = 0; t < triangleCount; ++t)
+			for (int k = 0; k < 3; ++k)
+				adjacency[fill[indices[t * 3 + k]]++] = t;
+		std::vector<int> cachePosition(vertexCount, -1);
+		std::vector<float> scores(vertexCount);
+		for (unsigned v = 0; v < vertexCount; ++v)
+			scores[v] = vertexScore(-1, activeTriangles[v]);
+		std::vector<float> triangleScores(triangleCount);
+		for (unsigned t = 0; t < triangleCount; ++t)
+			triangleScores[t] = scores[indices[t * 3]] + scores[indices[t * 3 + 1]] + scores[indices[t * 3 + 2]];
+		std::vector<char> emitted(triangleCount, 0);
+		std::vector<unsigned> output;
+		output.reserve(triangleCount * 3);
+		std::vector<unsigned> cache, nextCache;
+		cache.reserve(cacheSize + 3);
+		nextCache.reserve(cacheSize + 3);
+		unsigned bestTriangle = 0, scanStart = 0;
+		for (unsigned t = 1; t < triangleCount; ++t)
+			if (triangleScores[t] > triangleScores[bestTriangle])
+				bestTriangle = t;
+		while (true) {
+			emitted[bestTriangle] = 1;
+			const unsigned* triangle = indices + bestTriangle * 3;
+			output.insert(output.end(), triangle, triangle + 3);
+			// drop the triangle from its vertices' adjacency lists
+			for (int k = 0; k < 3; ++k) {
+				unsigned v = triangle[k];
+				unsigned* first = adjacency.data() + adjacencyStart[v];
+				unsigned* last = first + activeTriangles[v];
+				std::iter_swap(std::find(first, last, bestTriangle), last - 1);
+				--activeTriangles[v];
+			}
+			// move its vertices to the front of the LRU cache
+			nextCache.assign(triangle, triangle + 3);
+			for (unsigned v : cache)
+				if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+					nextCache.push_back(v);
+			for (unsigned i = 0; i < nextCache.size(); ++i) {
+				unsigned v = nextCache[i];
+				cachePosition[v] = (i < cacheSize) ? static_cast<int>(i) : -1;
+				scores[v] = vertexScore(cachePosition[v], activeTriangles[v]);
+			}
+			if (nextCache.size() > cacheSize)
+				nextCache.resize(cacheSize);
+			cache.swap(nextCache);
+			// only triangles touching the cache changed score, pick the best among them
+			float bestScore = -1.0f;
+			bool found = false;
+			for (unsigned v : cache)
+				for (unsigned a = 0; a < activeTriangles[v]; ++a) {
+					unsigned t = adjacency[adjacencyStart[v] + a];
+					triangleScores[t] = scores[indices[t * 3]] + scores[indices[t * 3 + 1]] + scores[indices[t * 3 + 2]];
+					if (triangleScores[t] > bestScore) {
+						bestScore = triangleScores[t];
+						bestTriangle = t;
+						found = true;
+					}
+				}
+			if (found == false) { // cache ran dry, continue with the next unused triangle
+				while (scanStart < triangleCount && emitted[scanStart])
+					++scanStart;
+				if (scanStart == triangleCount)
+					break;
+				bestTriangle = scanStart;
+			}
+		}
+		std::copy(output.begin(), output.end(), indices);
+	}
+
+	// Reorders clusters of an already cache optimized range so outward facing triangles draw first.
+	// Sander et al. "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw":
+	// clusters end where the cache goes cold, so moving them around costs at most ~threshold in ACMR.
+	inline void OptimizeOverdraw(unsigned* indices, unsigned indexCount,
+		const VERTEX* vertices, unsigned vertexCount, float threshold = 1.05f)
+	{
+		const unsigned triangleCount = indexCount / 3;
+		if (triangleCount < 2)
+			return;
+		for (unsigned i = 0; i < triangleCount * 3; ++i)
+			if (indices[i] >= vertexCount)
+				return;
+		constexpr unsigned cacheSize = 16;
+		std::vector<unsigned> loadedAt(vertexCount, 0);
+		unsigned time = 0;
+		auto resetCache = [&]() { time += cacheSize + 1; }; // everything loaded so far is now stale
+		auto misses = [&](unsigned t) {
+			unsigned count = 0;
+			for (int k = 0; k < 3; ++k) {
+				unsigned v = indices[t * 3 + k];
+				if (loadedAt[v] == 0 || time + 1 - loadedAt[v] > cacheSize) {
+					loadedAt[v] = ++time;
+					++count;
+				}
+			}
+			return count;
+		};
+		// hard boundaries: triangles that miss on every vertex start a new cluster anyway
+		std::vector<unsigned> hard;
+		for (unsigned t = 0; t < triangleCount; ++t)
+			if (misses(t) == 3 || t == 0)
+				hard.push_back(t);
+		hard.push_back(triangleCount);
+		// soft boundaries: split further wherever the cluster so far is already as efficient as the whole
+		std::vector<unsigned> clusters;
+		for (unsigned h = 0; h + 1 < hard.size(); ++h) {
+			unsigned start = hard[h], end = hard[h + 1];
+			resetCache();
+			unsigned clusterMisses = 0;
+			for (unsigned t = start; t < end; ++t)
+				clusterMisses += misses(t);
+			float limit = threshold * clusterMisses / (end - start);
+			resetCache();
+			unsigned softStart = start, softMisses = 0;
+			clusters.push_back(start);
+			for (unsigned t = start; t < end; ++t) {
+				softMisses += misses(t);
+				if (t + 1 < end && softMisses <= limit * (t + 1 - softStart)) {
+					clusters.push_back(t + 1);
+					softStart = t + 1;
+					softMisses = 0;
+					resetCache();
+				}
+			}
+		}
+		clusters.push_back(triangleCount);
+		// sort key: how far each cluster faces away from the center of the range
+		auto position = [&](unsigned i) { return vertices[indices[i]].pos; };
+		float center[3] = { 0, 0, 0 };
+		for (unsigned i = 0; i < triangleCount * 3; ++i) {
+			center[0] += position(i).x;
+			center[1] += position(i).y;
+			center[2] += position(i).z;
+		}
+		for (float& c : center)
+			c /= triangleCount * 3;
+		const unsigned clusterCount = static_cast<unsigned>(clusters.size() - 1);
+		std::vector<float> keys(clusterCount);
+		for (unsigned c = 0; c < clusterCount; ++c) {
+			float centroid[3] = { 0, 0, 0 }, normal[3] = { 0, 0, 0 }, area = 0;
+			for (unsigned t = clusters[c]; t < clusters[c + 1]; ++t) {
+				VECTOR a = position(t * 3), b = position(t * 3 + 1), d = position(t * 3 + 2);
+				float e1[3] = { b.x - a.x, b.y - a.y, b.z - a.z };
+				float e2[3] = { d.x - a.x, d.y - a.y, d.z - a.z };
+				// area weighted normal
+				float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+				float w = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+				centroid[0] += (a.x + b.x + d.x) * w / 3;
+				centroid[1] += (a.y + b.y + d.y) * w / 3;
+				centroid[2] += (a.z + b.z + d.z) * w / 3;
+				normal[0] += n[0];
+				normal[1] += n[1];
+				normal[2] += n[2];
+				area += w;
+			}
+			float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			if (area == 0.0f || length == 0.0f)
+				continue; // degenerate, key stays 0
+			keys[c] = ((centroid[0] / area - center[0]) * normal[0] +
+				(centroid[1] / area - center[1]) * normal[1] +
+				(centroid[2] / area - center[2]) * normal[2]) / length;
+		}
+		std::vector<unsigned> order(clusterCount);
+		for (unsigned c = 0; c < clusterCount; ++c)
+			order[c] = c;
+		std::stable_sort(order.begin(), order.end(), [&](unsigned a, unsigned b) { return keys[a] > keys[b]; });
+		std::vector<unsigned> output;
+		output.reserve(triangleCount * 3);
+		for (unsigned c : order)
+			output.insert(output.end(), indices + clusters[c] * 3, indices + clusters[c + 1] * 3);
+		std::copy(output.begin(), output.end(), indices);
+	}
+
+	// Merges duplicate vertices and remaps indices, the survivors keep their original order.
+	// epsilon 0 merges bit-identical vertices only, otherwise every component must be within epsilon.
+	// Returns the new vertex count, vertices past it are left unspecified.
+	inline unsigned WeldVertices(VERTEX* vertices, unsigned vertexCount,
+		unsigned* indices, unsigned indexCount, float epsilon = 0.0f)
+	{
+		std::vector<unsigned> remap(vertexCount);
+		unsigned unique = 0;
+		if (epsilon <= 0.0f) {
+			auto hash = [vertices](unsigned v) {
+				const unsigned char* bytes = reinterpret_cast<const unsigned char*>(vertices + v);
+				size_t h = 14695981039346656037ull; // FNV-1a
+				for (unsigned i = 0; i < sizeof(VERTEX); ++i)
+					h = (h ^ bytes[i]) * 1099511628211ull;
+				return h;
+			};
+			auto equal = [vertices](unsigned a, unsigned b) {
+				return std::memcmp(vertices + a, vertices + b, sizeof(VERTEX)) == 0;
+			};
+			std::unordered_map<unsigned, unsigned, decltype(hash), decltype(equal)>
+				seen(vertexCount, hash, equal);
+			// keys are compacted slots, unique <= v so the candidate never overwrites unread vertices
+			for (unsigned v = 0; v < vertexCount; ++v) {
+				vertices[unique] = vertices[v];
+				auto found = seen.emplace(unique, unique);
+				if (found.second)
+					++unique;
+				remap[v] = found.first->second;
+			}
+		}
+		else {
+			// hash positions on an epsilon sized grid, near matches can only be in the 27 surrounding cells
+			auto cell = [epsilon](float value) { return static_cast<long long>(std::floor(value / epsilon)); };
+			auto key = [](long long x, long long y, long long z) {
+				return static_cast<unsigned long long>(x * 73856093ll ^ y * 19349663ll ^ z * 83492791ll);
+			};
+			auto near = [epsilon](const VERTEX& a, const VERTEX& b) {
+				const float* fa = &a.pos.x;
+				const float* fb = &b.pos.x;
+				for (int i = 0; i < 9; ++i)
+					if (std::fabs(fa[i] - fb[i]) > epsilon)
+						return false;
+				return true;
+			};
+			std::unordered_multimap<unsigned long long, unsigned> grid(vertexCount);
+			std::vector<VERTEX> welded;
+			welded.reserve(vertexCount);
+			for (unsigned v = 0; v < vertexCount; ++v) {
+				const VERTEX& vertex = vertices[v];
+				long long x = cell(vertex.pos.x), y = cell(vertex.pos.y), z = cell(vertex.pos.z);
+				unsigned match = unique;
+				for (long long dx = -1; dx <= 1 && match == unique; ++dx)
+					for (long long dy = -1; dy <= 1 && match == unique; ++dy)
+						for (long long dz = -1; dz <= 1 && match == unique; ++dz) {
+							auto range = grid.equal_range(key(x + dx, y + dy, z + dz));
+							for (auto i = range.first; i != range.second; ++i)
+								if (near(welded[i->second], vertex)) {
+									match = i->second;
+									break;
+								}
+						}
+				if (match == unique) { // first of its kind
+					grid.emplace(key(x, y, z), unique);
+					welded.push_back(vertex);
+					++unique;
+				}
+				remap[v] = match;
+			}
+			std::copy(welded.begin(), welded.end(), vertices);
+		}
+		for (unsigned i = 0; i < indexCount; ++i)
+			if (indices[i] < vertexCount)
+				indices[i] = remap[indices[i]];
+		return unique;
+	}
+
+	// Renumbers vertices in the order the indices first reference them so fetches walk memory forward.
+	// Unreferenced vertices keep their relative order at the end, vertexCount never changes.
+	inline void OptimizeVertexFetch(VERTEX* vertices, unsigned vertexCount, unsigned* indices, unsigned indexCount)
+	{
+		constexpr unsigned unassigned = ~0u;
+		std::vector<unsigned> remap(vertexCount, unassigned);
+		unsigned next = 0;
+		for (unsigned i = 0; i < indexCount; ++i)
+			if (indices[i] < vertexCount && remap[indices[i]] == unassigned)
+				remap[indices[i]] = next++;
+		for (unsigned v = 0; v < vertexCount; ++v)
+			if (remap[v] == unassigned)
+				remap[v] = next++;
+		std::vector<VERTEX> reordered(vertexCount);
+		for (unsigned v = 0; v < vertexCount; ++v)
+			reordered[remap[v]] = vertices[v];
+		std::copy(reordered.begin(), reordered.end(), vertices);
+		for (unsigned i = 0; i < indexCount; ++i)
+			if (indices[i] < vertexCount)
+				indices[i] = remap[indices[i]];
+	}
+}
+#endif
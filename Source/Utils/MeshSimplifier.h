@@ -0,0 +1,406 @@
+#ifndef _MESHSIMPLIFIER_H_
+#define _MESHSIMPLIFIER_H_
+#include <cmath>
+#include <cfloat>
+#include <cstring>
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <unordered_map>
+#include "h2bParser.h"
+
+namespace H2B {
+
+	// Symmetric 4x4 error matrix of a set of planes (Garland & Heckbert), weight is the total plane area
+	struct QUADRIC {
+		double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2, weight;
+		void AddPlane(double a, double b, double c, double d, double w) {
+			a2 += w * a * a; ab += w * a * b; ac += w * a * c; ad += w * a * d;
+			b2 += w * b * b; bc += w * b * c; bd += w * b * d;
+			c2 += w * c * c; cd += w * c * d;
+			d2 += w * d * d;
+			weight += w;
+		}
+		void Add(const QUADRIC& q) {
+			a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad;
+			b2 += q.b2; bc += q.bc; bd += q.bd;
+			c2 += q.c2; cd += q.cd;
+			d2 += q.d2;
+			weight += q.weight;
+		}
+		// weighted sum of squared distances from p to every plane
+		double Evaluate(const VECTOR& p) const {
+			double x = p.x, y = p.y, z = p.z;
+			double error = a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x +
+				b2 * y * y + 2 * bc * y * z + 2 * bd * y +
+				c2 * z * z + 2 * cd * z + d2;
+			return error > 0 ? error : 0;
+		}
+	};
+
+	// Reduces a triangle list to about targetIndexCount indices by collapsing edges onto existing vertices,
+	// so the result still indexes the same vertex array. Vertices sharing a position collapse together
+	// (no cracks along uv or normal seams) and open borders are held in place by penalty planes.
+	// Stops early when nothing can collapse without flipping a face.
+	// Returns how far any removed position ended up from the remaining surface, in position units.
+	inline float SimplifyMesh(std::vector<unsigned>& indices, const VERTEX* vertices, unsigned vertexCount,
+		unsigned targetIndexCount)
+	{
+		const unsigned triangleCount = static_cast<unsigned>(indices.size() / 3);
+		indices.resize(triangleCount * 3);
+		for (unsigned i : indices)
+			if (i >= vertexCount)
+				return 0; // out of range index, leave the data as exported
+		if (indices.size() <= targetIndexCount)
+			return 0;
+		// group vertices by position, collapses happen between positions
+		std::vector<unsigned> positionOf(vertexCount, ~0u);
+		std::vector<VECTOR> positions;
+		std::vector<std::vector<unsigned>> wedges; // vertices found at each position
+		{
+			struct KeyHash {
+				size_t operator()(const VECTOR& v) const {
+					unsigned bits[3];
+					std::memcpy(bits, &v, sizeof(bits));
+					return bits[0] * 73856093u ^ bits[1] * 19349663u ^ bits[2] * 83492791u;
+				}
+			};
+			struct KeyEqual {
+				bool operator()(const VECTOR& a, const VECTOR& b) const {
+					return std::memcmp(&a, &b, sizeof(VECTOR)) == 0;
+				}
+			};
+			std::unordered_map<VECTOR, unsigned, KeyHash, KeyEqual> lookup;
+			for (unsigned i : indices) {
+				if (positionOf[i] != ~0u)
+					continue;
+				auto found = lookup.emplace(vertices[i].pos, static_cast<unsigned>(positions.size()));
+				if (found.second) {
+					positions.push_back(vertices[i].pos);
+					wedges.emplace_back();
+				}
+				positionOf[i] = found.first->second;
+				wedges[found.first->second].push_back(i);
+			}
+		}
+		const unsigned positionCount = static_cast<unsigned>(positions.size());
+		auto plane = [&](unsigned a, unsigned b, unsigned c, double out[4]) {
+			const VECTOR& p0 = positions[a];
+			const VECTOR& p1 = positions[b];
+			const VECTOR& p2 = positions[c];
+			double e1[3] = { p1.x - p0.x, p1.y - p0.y, p1.z - p0.z };
+			double e2[3] = { p2.x - p0.x, p2.y - p0.y, p2.z - p0.z };
+			out[0] = e1[1] * e2[2] - e1[2] * e2[1];
+			out[1] = e1[2] * e2[0] - e1[0] * e2[2];
+			out[2] = e1[0] * e2[1] - e1[1] * e2[0];
+			double length = std::sqrt(out[0] * out[0] + out[1] * out[1] + out[2] * out[2]);
+			if (length > 0) {
+				out[0] /= length; out[1] /= length; out[2] /= length;
+			}
+			out[3] = -(out[0] * p0.x + out[1] * p0.y + out[2] * p0.z);
+			return length; // twice the triangle area
+		};
+		// triangles by position, with each position's triangle list
+		std::vector<unsigned> corners(indices.size());
+		for (unsigned i = 0; i < indices.size(); ++i)
+			corners[i] = positionOf[indices[i]];
+		std::vector<char> alive(triangleCount, 1);
+		std::vector<std::vector<unsigned>> around(positionCount);
+		unsigned aliveCount = 0;
+		for (unsigned t = 0; t < triangleCount; ++t) {
+			const unsigned* c = &corners[t * 3];
+			if (c[0] == c[1] || c[1] == c[2] || c[0] == c[2]) {
+				alive[t] = 0; // already degenerate, dropped
+				continue;
+			}
+			++aliveCount;
+			for (int k = 0; k < 3; ++k)
+				around[c[k]].push_back(t);
+		}
+		// quadrics: every face plane weighted by its area
+		std::vector<QUADRIC> quadrics(positionCount, QUADRIC{});
+		std::unordered_map<unsigned long long, unsigned> edgeUse;
+		auto edgeKey = [](unsigned a, unsigned b) {
+			return (a < b) ? (static_cast<unsigned long long>(a) << 32 | b) : (static_cast<unsigned long long>(b) << 32 | a);
+		};
+		for (unsigned t = 0; t < triangleCount; ++t) {
+			if (alive[t] == 0)
+				continue;
+			const unsigned* c = &corners[t * 3];
+			double p[4];
+			double area = plane(c[0], c[1], c[2], p) * 0.5;
+			for (int k = 0; k < 3; ++k) {
+				quadrics[c[k]].AddPlane(p[0], p[1], p[2], p[3], area);
+				++edgeUse[edgeKey(c[k], c[(k + 1) % 3])];
+			}
+		}
+		// open borders get a steep plane standing on the edge so collapses can't pull them inward
+		for (unsigned t = 0; t < triangleCount; ++t) {
+			if (alive[t] == 0)
+				continue;
+			const unsigned* c = &corners[t * 3];
+			double n[4];
+			plane(c[0], c[1], c[2], n);
+			for (int k = 0; k < 3; ++k) {
+				unsigned a = c[k], b = c[(k + 1) % 3];
+				if (edgeUse[edgeKey(a, b)] != 1)
+					continue;
+				double edge[3] = { positions[b].x - positions[a].x, positions[b].y - positions[a].y,
+					positions[b].z - positions[a].z };
+				double side[3] = { edge[1] * n[2] - edge[2] * n[1], edge[2] * n[0] - edge[0] * n[2],
+					edge[0] * n[1] - edge[1] * n[0] };
+				double length = std::sqrt(side[0] * side[0] + side[1] * side[1] + side[2] * side[2]);
+				if (length == 0)
+					continue;
+				for (double& s : side)
+					s /= length;
+				double d = -(side[0] * positions[a].x + side[1] * positions[a].y + side[2] * positions[a].z);
+				double weight = 10.0 * (edge[0] * edge[0] + edge[1] * edge[1] + edge[2] * edge[2]);
+				quadrics[a].AddPlane(side[0], side[1], side[2], d, weight);
+				quadrics[b].AddPlane(side[0], side[1], side[2], d, weight);
+			}
+		}
+		// cheapest collapse first, stale entries are skipped through the version stamps
+		struct COLLAPSE {
+			double cost;
+			unsigned from, to, fromVersion, toVersion;
+			bool operator>(const COLLAPSE& other) const {
+				if (cost != other.cost)
+					return cost > other.cost;
+				return from != other.from ? from > other.from : to > other.to; // deterministic ties
+			}
+		};
+		std::vector<unsigned> version(positionCount, 0);
+		std::vector<char> removed(positionCount, 0);
+		std::priority_queue<COLLAPSE, std::vector<COLLAPSE>, std::greater<COLLAPSE>> heap;
+		auto consider = [&](unsigned from, unsigned to) {
+			QUADRIC q = quadrics[from];
+			q.Add(quadrics[to]);
+			double cost = (q.weight > 0) ? q.Evaluate(positions[to]) / q.weight : 0;
+			heap.push({ cost, from, to, version[from], version[to] });
+		};
+		for (auto& edge : edgeUse) {
+			unsigned a = static_cast<unsigned>(edge.first >> 32), b = static_cast<unsigned>(edge.first);
+			consider(a, b);
+			consider(b, a);
+		}
+		std::vector<unsigned> collapsedInto(positionCount, ~0u);
+		std::vector<unsigned> wedgeTarget, neighbours;
+		while (aliveCount * 3 > targetIndexCount && heap.empty() == false) {
+			COLLAPSE next = heap.top();
+			heap.pop();
+			if (removed[next.from] || removed[next.to] ||
+				next.fromVersion != version[next.from] || next.toVersion != version[next.to])
+				continue;
+			// the edge must still exist and no remaining face may flip over
+			bool connected = false, flips = false;
+			for (unsigned t : around[next.from]) {
+				if (alive[t] == 0)
+					continue;
+				const unsigned* c = &corners[t * 3];
+				if (c[0] == next.to || c[1] == next.to || c[2] == next.to) {
+					connected = true;
+					continue; // collapses away
+				}
+				double before[4], after[4];
+				plane(c[0], c[1], c[2], before);
+				unsigned moved[3] = { c[0], c[1], c[2] };
+				for (unsigned& m : moved)
+					if (m == next.from)
+						m = next.to;
+				if (plane(moved[0], moved[1], moved[2], after) == 0 ||
+					before[0] * after[0] + before[1] * after[1] + before[2] * after[2] < 0.2) {
+					flips = true;
+					break;
+				}
+			}
+			if (connected == false || flips)
+				continue;
+			// every vertex at "from" continues as the most similar vertex at "to"
+			const std::vector<unsigned>& targets = wedges[next.to];
+			wedgeTarget.clear();
+			for (unsigned w : wedges[next.from]) {
+				unsigned best = targets[0];
+				float bestScore = -FLT_MAX;
+				for (unsigned candidate : targets) {
+					const VERTEX& a = vertices[w];
+					const VERTEX& b = vertices[candidate];
+					float score = a.nrm.x * b.nrm.x + a.nrm.y * b.nrm.y + a.nrm.z * b.nrm.z -
+						std::fabs(a.uvw.x - b.uvw.x) - std::fabs(a.uvw.y - b.uvw.y);
+					if (score > bestScore) {
+						bestScore = score;
+						best = candidate;
+					}
+				}
+				wedgeTarget.push_back(best);
+			}
+			for (unsigned t : around[next.from]) {
+				if (alive[t] == 0)
+					continue;
+				unsigned* c = &corners[t * 3];
+				if (c[0] == next.to || c[1] == next.to || c[2] == next.to) {
+					alive[t] = 0;
+					--aliveCount;
+					continue;
+				}
+				for (int k = 0; k < 3; ++k)
+					if (c[k] == next.from) {
+						c[k] = next.to;
+						const std::vector<unsigned>& from = wedges[next.from];
+						for (unsigned w = 0; w < from.size(); ++w)
+							if (from[w] == indices[t * 3 + k])
+								indices[t * 3 + k] = wedgeTarget[w];
+					}
+				around[next.to].push_back(t);
+			}
+			around[next.from].clear();
+			std::vector<unsigned>& merged = around[next.to]; // drop dead & repeated triangles
+			merged.erase(std::remove_if(merged.begin(), merged.end(),
+				[&](unsigned t) { return alive[t] == 0; }), merged.end());
+			std::sort(merged.begin(), merged.end());
+			merged.erase(std::unique(merged.begin(), merged.end()), merged.end());
+			removed[next.from] = 1;
+			collapsedInto[next.from] = next.to;
+			quadrics[next.to].Add(quadrics[next.from]);
+			++version[next.to];
+			// the merged position has new costs with all of its neighbours
+			neighbours.clear();
+			for (unsigned t : merged)
+				for (int k = 0; k < 3; ++k)
+					if (corners[t * 3 + k] != next.to)
+						neighbours.push_back(corners[t * 3 + k]);
+			std::sort(neighbours.begin(), neighbours.end());
+			neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+			for (unsigned n : neighbours) {
+				consider(next.to, n);
+				consider(n, next.to);
+			}
+		}
+		// measure how far the positions that were lost are from the remaining surface,
+		// the remaining triangles are bucketed in a uniform grid so only nearby cells get searched
+		auto distanceToTriangle = [](const VECTOR& p, const VECTOR& a, const VECTOR& b, const VECTOR& c) {
+			// Ericson, Real-Time Collision Detection 5.1.5
+			auto sub = [](const VECTOR& x, const VECTOR& y) { return VECTOR{ x.x - y.x, x.y - y.y, x.z - y.z }; };
+			auto dot = [](const VECTOR& x, const VECTOR& y) { return x.x * y.x + x.y * y.y + x.z * y.z; };
+			VECTOR ab = sub(b, a), ac = sub(c, a), ap = sub(p, a), closest;
+			float d1 = dot(ab, ap), d2 = dot(ac, ap);
+			VECTOR bp = sub(p, b), cp = sub(p, c);
+			float d3 = dot(ab, bp), d4 = dot(ac, bp), d5 = dot(ab, cp), d6 = dot(ac, cp);
+			float va = d3 * d6 - d5 * d4, vb = d5 * d2 - d1 * d6, vc = d1 * d4 - d3 * d2;
+			if (d1 <= 0 && d2 <= 0)
+				closest = a;
+			else if (d3 >= 0 && d4 <= d3)
+				closest = b;
+			else if (d6 >= 0 && d5 <= d6)
+				closest = c;
+			else if (vc <= 0 && d1 >= 0 && d3 <= 0) {
+				float v = d1 / (d1 - d3);
+				closest = { a.x + ab.x * v, a.y + ab.y * v, a.z + ab.z * v };
+			}
+			else if (vb <= 0 && d2 >= 0 && d6 <= 0) {
+				float w = d2 / (d2 - d6);
+				closest = { a.x + ac.x * w, a.y + ac.y * w, a.z + ac.z * w };
+			}
+			else if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0) {
+				float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+				closest = { b.x + (c.x - b.x) * w, b.y + (c.y - b.y) * w, b.z + (c.z - b.z) * w };
+			}
+			else {
+				float denominator = 1.0f / (va + vb + vc);
+				float v = vb * denominator, w = vc * denominator;
+				closest = { a.x + ab.x * v + ac.x * w, a.y + ab.y * v + ac.y * w, a.z + ab.z * v + ac.z * w };
+			}
+			VECTOR offset = sub(p, closest);
+			return std::sqrt(dot(offset, offset));
+		};
+		VECTOR low = { FLT_MAX, FLT_MAX, FLT_MAX }, high = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+		for (unsigned t = 0; t < triangleCount; ++t) {
+			if (alive[t] == 0)
+				continue;
+			for (int k = 0; k < 3; ++k) {
+				const VECTOR& p = positions[corners[t * 3 + k]];
+				low = { std::fmin(low.x, p.x), std::fmin(low.y, p.y), std::fmin(low.z, p.z) };
+				high = { std::fmax(high.x, p.x), std::fmax(high.y, p.y), std::fmax(high.z, p.z) };
+			}
+		}
+		float error = 0;
+		if (aliveCount == 0) { // nothing is left, count the whole mesh as lost
+			for (const VECTOR& p : positions) {
+				low = { std::fmin(low.x, p.x), std::fmin(low.y, p.y), std::fmin(low.z, p.z) };
+				high = { std::fmax(high.x, p.x), std::fmax(high.y, p.y), std::fmax(high.z, p.z) };
+			}
+			VECTOR diagonal = { high.x - low.x, high.y - low.y, high.z - low.z };
+			indices.clear();
+			return std::sqrt(diagonal.x * diagonal.x + diagonal.y * diagonal.y + diagonal.z * diagonal.z);
+		}
+		const float extent[3] = { high.x - low.x, high.y - low.y, high.z - low.z };
+		const float largest = std::fmax(std::fmax(extent[0], extent[1]), std::fmax(extent[2], FLT_MIN));
+		const float cellSize = largest / std::fmin(64.0f, std::fmax(1.0f, std::cbrt(static_cast<float>(aliveCount))));
+		int cells[3];
+		for (int axis = 0; axis < 3; ++axis)
+			cells[axis] = std::max(1, std::min(64, static_cast<int>(std::ceil(extent[axis] / cellSize))));
+		auto cellOf = [&](float value, int axis) {
+			float origin = (axis == 0) ? low.x : (axis == 1) ? low.y : low.z;
+			return std::max(0, std::min(cells[axis] - 1, static_cast<int>((value - origin) / cellSize)));
+		};
+		std::vector<std::vector<unsigned>> grid(static_cast<size_t>(cells[0]) * cells[1] * cells[2]);
+		for (unsigned t = 0; t < triangleCount; ++t) {
+			if (alive[t] == 0)
+				continue;
+			const VECTOR& a = positions[corners[t * 3]];
+			const VECTOR& b = positions[corners[t * 3 + 1]];
+			const VECTOR& c = positions[corners[t * 3 + 2]];
+			int from[3] = { cellOf(std::fmin(a.x, std::fmin(b.x, c.x)), 0), cellOf(std::fmin(a.y, std::fmin(b.y, c.y)), 1),
+				cellOf(std::fmin(a.z, std::fmin(b.z, c.z)), 2) };
+			int to[3] = { cellOf(std::fmax(a.x, std::fmax(b.x, c.x)), 0), cellOf(std::fmax(a.y, std::fmax(b.y, c.y)), 1),
+				cellOf(std::fmax(a.z, std::fmax(b.z, c.z)), 2) };
+			for (int z = from[2]; z <= to[2]; ++z)
+				for (int y = from[1]; y <= to[1]; ++y)
+					for (int x = from[0]; x <= to[0]; ++x)
+						grid[(static_cast<size_t>(z) * cells[1] + y) * cells[0] + x].push_back(t);
+		}
+		std::vector<unsigned> tested(triangleCount, ~0u); // last position each triangle was measured against
+		const int maxRing = std::max(cells[0], std::max(cells[1], cells[2]));
+		// every position no remaining triangle touches, the removed ones and any whose triangles all collapsed
+		std::vector<char> kept(positionCount, 0);
+		for (unsigned t = 0; t < triangleCount; ++t)
+			for (int k = 0; k < 3 && alive[t]; ++k)
+				kept[corners[t * 3 + k]] = 1;
+		for (unsigned p = 0; p < positionCount; ++p) {
+			if (kept[p])
+				continue;
+			const VECTOR& point = positions[p];
+			const int home[3] = { cellOf(point.x, 0), cellOf(point.y, 1), cellOf(point.z, 2) };
+			float nearest = FLT_MAX;
+			// grow a shell of cells until nothing outside it can be closer than what was found
+			for (int ring = 0; ring <= maxRing && nearest > (ring - 1) * cellSize; ++ring)
+				for (int z = home[2] - ring; z <= home[2] + ring; ++z)
+					for (int y = home[1] - ring; y <= home[1] + ring; ++y)
+						for (int x = home[0] - ring; x <= home[0] + ring; ++x) {
+							if (x < 0 || y < 0 || z < 0 || x >= cells[0] || y >= cells[1] || z >= cells[2])
+								continue;
+							if (std::abs(x - home[0]) != ring && std::abs(y - home[1]) != ring && std::abs(z - home[2]) != ring)
+								continue; // inside the shell, already searched
+							for (unsigned t : grid[(static_cast<size_t>(z) * cells[1] + y) * cells[0] + x]) {
+								if (tested[t] == p)
+									continue;
+								tested[t] = p;
+								nearest = std::fmin(nearest, distanceToTriangle(point, positions[corners[t * 3]],
+									positions[corners[t * 3 + 1]], positions[corners[t * 3 + 2]]));
+							}
+						}
+			error = std::fmax(error, nearest);
+		}
+		// keep the surviving triangles in their original order
+		unsigned write = 0;
+		for (unsigned t = 0; t < triangleCount; ++t)
+			if (alive[t]) {
+				for (int k = 0; k < 3; ++k)
+					indices[write * 3 + k] = indices[t * 3 + k];
+				++write;
+			}
+		indices.resize(write * 3);
+		return error;
+	}
+}
+#endif
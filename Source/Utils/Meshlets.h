@@ -0,0 +1,134 @@
+#ifndef _MESHLETS_H_
+#define _MESHLETS_H_
+#include <cmath>
+#include <vector>
+#include "h2bParser.h"
+
+namespace H2B {
+
+	// size limits of a single meshlet (the common mesh shader sweet spot)
+	constexpr unsigned MESHLET_MAX_VERTICES = 64;
+	constexpr unsigned MESHLET_MAX_TRIANGLES = 124;
+
+	// A contiguous run of triangles inside one mesh, drawable as its own index range
+	struct MESHLET {
+		unsigned indexOffset, indexCount; // same space as BATCH, relative to the model's indices
+		VECTOR center; float radius; // bounding sphere in model space
+		VECTOR coneAxis; float coneCutoff; // normal cone, coneCutoff of 1 means it can't be backface culled
+	};
+
+	// Bounding sphere and normal cone of a run of triangles.
+	// Front faces are clockwise in a left handed space, matching the renderer's default rasterizer.
+	inline MESHLET ComputeMeshletBounds(const unsigned* indices, unsigned indexCount, const VERTEX* vertices)
+	{
+		MESHLET out = { 0, indexCount, { 0, 0, 0 }, 0, { 0, 0, 1 }, 1 };
+		if (indexCount == 0)
+			return out;
+		auto distanceSq = [](const VECTOR& a, const VECTOR& b) {
+			float x = a.x - b.x, y = a.y - b.y, z = a.z - b.z;
+			return x * x + y * y + z * z;
+		};
+		// Ritter's sphere: span the two points furthest apart then grow to fit everything
+		VECTOR first = vertices[indices[0]].pos, a = first, b = first;
+		for (unsigned i = 0; i < indexCount; ++i)
+			if (distanceSq(vertices[indices[i]].pos, first) > distanceSq(a, first))
+				a = vertices[indices[i]].pos;
+		for (unsigned i = 0; i < indexCount; ++i)
+			if (distanceSq(vertices[indices[i]].pos, a) > distanceSq(b, a))
+				b = vertices[indices[i]].pos;
+		out.center = { (a.x + b.x) * 0.5f, (a.y + b.y) * 0.5f, (a.z + b.z) * 0.5f };
+		out.radius = std::sqrt(distanceSq(a, b)) * 0.5f;
+		for (unsigned i = 0; i < indexCount; ++i) {
+			const VECTOR& p = vertices[indices[i]].pos;
+			float distance = std::sqrt(distanceSq(p, out.center));
+			if (distance > out.radius) { // move the center just enough to reach p
+				float grow = (distance - out.radius) * 0.5f / distance;
+				out.center.x += (p.x - out.center.x) * grow;
+				out.center.y += (p.y - out.center.y) * grow;
+				out.center.z += (p.z - out.center.z) * grow;
+				out.radius = (out.radius + distance) * 0.5f;
+			}
+		}
+		// normal cone: average face direction and how far the faces stray from it
+		std::vector<VECTOR> normals;
+		normals.reserve(indexCount / 3);
+		VECTOR axis = { 0, 0, 0 };
+		for (unsigned i = 0; i + 2 < indexCount; i += 3) {
+			const VECTOR& p0 = vertices[indices[i]].pos;
+			const VECTOR& p1 = vertices[indices[i + 1]].pos;
+			const VECTOR& p2 = vertices[indices[i + 2]].pos;
+			VECTOR e1 = { p1.x - p0.x, p1.y - p0.y, p1.z - p0.z };
+			VECTOR e2 = { p2.x - p0.x, p2.y - p0.y, p2.z - p0.z };
+			VECTOR n = { e1.y * e2.z - e1.z * e2.y, e1.z * e2.x - e1.x * e2.z, e1.x * e2.y - e1.y * e2.x };
+			float length = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+			if (length == 0.0f)
+				continue; // degenerate, faces no direction
+			n = { n.x / length, n.y / length, n.z / length };
+			normals.push_back(n);
+			axis = { axis.x + n.x, axis.y + n.y, axis.z + n.z };
+		}
+		float length = std::sqrt(axis.x * axis.x + axis.y * axis.y + axis.z * axis.z);
+		if (normals.empty() || length == 0.0f)
+			return out;
+		out.coneAxis = { axis.x / length, axis.y / length, axis.z / length };
+		float minDot = 1.0f;
+		for (const VECTOR& n : normals)
+			minDot = std::fmin(minDot, n.x * out.coneAxis.x + n.y * out.coneAxis.y + n.z * out.coneAxis.z);
+		// faces spread over a hemisphere or more, some always face the camera
+		out.coneCutoff = (minDot <= 0.0f) ? 1.0f : std::sqrt(1.0f - minDot * minDot);
+		return out;
+	}
+
+	// Splits one draw range into meshlets without moving any triangles, so run it on
+	// cache optimized indices and each meshlet will already be a tight cluster.
+	// Appends to outMeshlets, returns how many were added.
+	inline unsigned BuildMeshlets(const unsigned* indices, BATCH range, const VERTEX* vertices,
+		unsigned vertexCount, std::vector<MESHLET>& outMeshlets)
+	{
+		const unsigned before = static_cast<unsigned>(outMeshlets.size());
+		const unsigned end = range.indexOffset + range.indexCount - range.indexCount % 3;
+		for (unsigned i = range.indexOffset; i < end; ++i)
+			if (indices[i] >= vertexCount)
+				return 0; // out of range index, the range gets no meshlets
+		// which meshlet last used each vertex, avoids clearing a set per meshlet
+		std::vector<unsigned> owner(vertexCount, ~0u);
+		unsigned meshlet = 0, start = range.indexOffset, uniqueVertices = 0;
+		auto close = [&](unsigned last) {
+			MESHLET out = ComputeMeshletBounds(indices + start, last - start, vertices);
+			out.indexOffset = start;
+			outMeshlets.push_back(out);
+			start = last;
+			uniqueVertices = 0;
+			++meshlet;
+		};
+		for (unsigned i = range.indexOffset; i < end; i += 3) {
+			unsigned added = 0;
+			for (int k = 0; k < 3; ++k)
+				if (owner[indices[i + k]] != meshlet)
+					++added;
+			// shared corners of a degenerate triangle are counted twice, which only errs on the safe side
+			if (i > start && (uniqueVertices + added > MESHLET_MAX_VERTICES ||
+				(i - start) / 3 + 1 > MESHLET_MAX_TRIANGLES))
+				close(i);
+			for (int k = 0; k < 3; ++k)
+				if (owner[indices[i + k]] != meshlet) {
+					owner[indices[i + k]] = meshlet;
+					++uniqueVertices;
+				}
+		}
+		if (end > start)
+			close(end);
+		return static_cast<unsigned>(outMeshlets.size()) - before;
+	}
+
+	// true when every triangle of the meshlet faces away from a camera at cameraPos (model space)
+	inline bool IsMeshletBackfacing(const MESHLET& meshlet, const VECTOR& cameraPos)
+	{
+		VECTOR toCenter = { meshlet.center.x - cameraPos.x, meshlet.center.y - cameraPos.y,
+			meshlet.center.z - cameraPos.z };
+		float distance = std::sqrt(toCenter.x * toCenter.x + toCenter.y * toCenter.y + toCenter.z * toCenter.z);
+		return toCenter.x * meshlet.coneAxis.x + toCenter.y * meshlet.coneAxis.y + toCenter.z * meshlet.coneAxis.z >=
+			meshlet.coneCutoff * distance + meshlet.radius;
+	}
+}
+#endif
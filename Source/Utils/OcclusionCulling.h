@@ -0,0 +1,272 @@
+#ifndef _OCCLUSIONCULLING_H_
+#define _OCCLUSIONCULLING_H_
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "FrustumCulling.h"
+
+// Small CPU depth buffer of the biggest occluders in view, used to skip instances hidden behind them.
+// Depth errs towards visible: an occluder writes the farthest depth its triangle reaches inside a pixel,
+// and an instance is hidden only when every pixel its box touches holds something nearer than the box's
+// nearest corner. Coverage is sampled at pixel centers like the GPU does, so meshes stay watertight and
+// only an occluder's outline may claim up to half a pixel more than it covers.
+// Coordinates are clip space of a DirectX style (row vector, 0 <= z <= w) view projection matrix.
+struct OCCLUSION_BUFFER {
+	// width must be a multiple of TILE_SIZE, tiles keep their farthest depth so hidden ones are tested at once
+	static constexpr unsigned TILE_SIZE = 8;
+	// boxes are tested this much nearer than they are, rasterized depth is only so precise
+	static constexpr float DEPTH_BIAS = 1e-5f;
+	unsigned width = 0, height = 0, tilesX = 0, tilesY = 0;
+	// nearest occluder depth of each pixel, rows from the bottom of the screen, 1 where nothing was drawn
+	std::vector<float> depth;
+	// farthest depth in each tile, only valid after Finish
+	std::vector<float> tileFarthest;
+
+	void Resize(unsigned _width, unsigned _height)
+	{
+		width = _width; height = _height;
+		tilesX = (width + TILE_SIZE - 1) / TILE_SIZE; tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+		depth.resize(width * height);
+		tileFarthest.resize(tilesX * tilesY);
+	}
+	void Clear()
+	{
+		std::fill(depth.begin(), depth.end(), 1.0f);
+	}
+
+	// draws the triangles of indices (relative to vertices) placed by worldViewProjection. Like the pipeline
+	// only clockwise (front) faces are drawn, a wall seen from behind hides nothing on the GPU either
+	void DrawMesh(const H2B::VERTEX* vertices, unsigned vertexCount, const unsigned* indices, unsigned indexCount,
+		const GW::MATH::GMATRIXF& worldViewProjection)
+	{
+		PlaceVertices(vertices, vertexCount, worldViewProjection);
+		DrawTriangles(indices, indexCount);
+	}
+	// DrawMesh in two steps, so several index ranges of one model share a single pass over its vertices.
+	// each vertex is shared by several triangles, only transform it once
+	void PlaceVertices(const H2B::VERTEX* vertices, unsigned vertexCount, const GW::MATH::GMATRIXF& worldViewProjection)
+	{
+		clipVertices.resize(vertexCount);
+		for (unsigned v = 0; v < vertexCount; v++)
+			clipVertices[v] = Transform(vertices[v].pos, worldViewProjection);
+	}
+	// indices are relative to the vertices last given to PlaceVertices
+	void DrawTriangles(const unsigned* indices, unsigned indexCount)
+	{
+		for (unsigned i = 0; i + 2 < indexCount; i += 3)
+		{
+			GW::MATH::GVECTORF clip[3] = { clipVertices[indices[i]], clipVertices[indices[i + 1]], clipVertices[indices[i + 2]] };
+			DrawClippedTriangle(clip);
+		}
+	}
+
+	// refreshes tileFarthest once every occluder is drawn
+	void Finish()
+	{
+		for (unsigned tileY = 0; tileY < tilesY; tileY++)
+			for (unsigned tileX = 0; tileX < tilesX; tileX++)
+			{
+				float farthest = 0;
+				const unsigned endY = std::min(height, (tileY + 1) * TILE_SIZE), endX = std::min(width, (tileX + 1) * TILE_SIZE);
+				for (unsigned y = tileY * TILE_SIZE; y < endY; y++)
+					for (unsigned x = tileX * TILE_SIZE; x < endX; x++)
+						farthest = std::max(farthest, depth[y * width + x]);
+				tileFarthest[tileY * tilesX + tileX] = farthest;
+			}
+	}
+
+	// false when the model space box (min, max) placed by worldViewProjection is behind the occluders
+	// everywhere it covers, or covers nothing on screen
+	bool BoxVisible(const H2B::VECTOR& min, const H2B::VECTOR& max, const GW::MATH::GMATRIXF& worldViewProjection) const
+	{
+		float left = FLT_MAX, right = -FLT_MAX, bottom = FLT_MAX, top = -FLT_MAX, nearest = FLT_MAX;
+		for (int corner = 0; corner < 8; corner++)
+		{
+			H2B::VECTOR point = { corner & 1 ? max.x : min.x, corner & 2 ? max.y : min.y, corner & 4 ? max.z : min.z };
+			GW::MATH::GVECTORF clip = Transform(point, worldViewProjection);
+			if (clip.z < 0)
+				return true; // reaches past the near plane, the camera may well be inside it
+			float x, y;
+			ToPixels(clip, x, y);
+			left = std::min(left, x); right = std::max(right, x);
+			bottom = std::min(bottom, y); top = std::max(top, y);
+			nearest = std::min(nearest, clip.z / clip.w);
+		}
+		// every pixel the rectangle touches
+		const int x0 = std::max(0, static_cast<int>(std::floor(left))), x1 = std::min(static_cast<int>(width) - 1, static_cast<int>(std::floor(right)));
+		const int y0 = std::max(0, static_cast<int>(std::floor(bottom))), y1 = std::min(static_cast<int>(height) - 1, static_cast<int>(std::floor(top)));
+		nearest -= DEPTH_BIAS;
+		for (int tileY = y0 / static_cast<int>(TILE_SIZE); tileY <= y1 / static_cast<int>(TILE_SIZE); tileY++)
+			for (int tileX = x0 / static_cast<int>(TILE_SIZE); tileX <= x1 / static_cast<int>(TILE_SIZE); tileX++)
+			{
+				if (tileFarthest[tileY * tilesX + tileX] < nearest)
+					continue; // all of the tile is in front
+				const int startY = std::max(y0, tileY * static_cast<int>(TILE_SIZE)), endY = std::min(y1, (tileY + 1) * static_cast<int>(TILE_SIZE) - 1);
+				const int startX = std::max(x0, tileX * static_cast<int>(TILE_SIZE)), endX = std::min(x1, (tileX + 1) * static_cast<int>(TILE_SIZE) - 1);
+				for (int y = startY; y <= endY; y++)
+					for (int x = startX; x <= endX; x++)
+						if (depth[y * width + x] >= nearest)
+							return true;
+			}
+		return false;
+	}
+
+private:
+	std::vector<GW::MATH::GVECTORF> clipVertices;
+
+	static GW::MATH::GVECTORF Transform(const H2B::VECTOR& p, const GW::MATH::GMATRIXF& m)
+	{
+		return { p.x * m.row1.x + p.y * m.row2.x + p.z * m.row3.x + m.row4.x,
+			p.x * m.row1.y + p.y * m.row2.y + p.z * m.row3.y + m.row4.y,
+			p.x * m.row1.z + p.y * m.row2.z + p.z * m.row3.z + m.row4.z,
+			p.x * m.row1.w + p.y * m.row2.w + p.z * m.row3.w + m.row4.w };
+	}
+	void ToPixels(const GW::MATH::GVECTORF& clip, float& x, float& y) const
+	{
+		x = (clip.x / clip.w * 0.5f + 0.5f) * width;
+		y = (clip.y / clip.w * 0.5f + 0.5f) * height;
+	}
+
+	// cuts off whatever is in front of the near plane (z < 0), leaving at most two triangles
+	void DrawClippedTriangle(const GW::MATH::GVECTORF clip[3])
+	{
+		GW::MATH::GVECTORF kept[4];
+		int count = 0;
+		for (int v = 0; v < 3; v++)
+		{
+			const GW::MATH::GVECTORF& a = clip[v];
+			const GW::MATH::GVECTORF& b = clip[(v + 1) % 3];
+			if (a.z >= 0)
+				kept[count++] = a;
+			if ((a.z >= 0) != (b.z >= 0))
+			{
+				float t = a.z / (a.z - b.z);
+				kept[count++] = { a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, 0, a.w + (b.w - a.w) * t };
+			}
+		}
+		if (count >= 3)
+			DrawTriangle(kept[0], kept[1], kept[2]);
+		if (count == 4)
+			DrawTriangle(kept[0], kept[2], kept[3]);
+	}
+
+	void DrawTriangle(const GW::MATH::GVECTORF& clipA, const GW::MATH::GVECTORF& clipB, const GW::MATH::GVECTORF& clipC)
+	{
+		float x[3], y[3], z[3];
+		const GW::MATH::GVECTORF* clip[3] = { &clipA, &clipB, &clipC };
+		for (int v = 0; v < 3; v++)
+		{
+			if (clip[v]->w <= 0)
+				return;
+			ToPixels(*clip[v], x[v], y[v]);
+			z[v] = clip[v]->z / clip[v]->w;
+		}
+		// rows count up the screen here, so clockwise on screen turns into a positive area
+		float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+		if (area < 1e-6f)
+			return;
+		// edge i is inside where edgeX[i] * px + edgeY[i] * py + edgeC[i] >= 0
+		float edgeX[3], edgeY[3], edgeC[3];
+		for (int e = 0; e < 3; e++)
+		{
+			const int a = (e + 1) % 3, b = (e + 2) % 3;
+			edgeX[e] = y[a] - y[b];
+			edgeY[e] = x[b] - x[a];
+			edgeC[e] = x[a] * y[b] - x[b] * y[a];
+		}
+		// depth is linear in screen space, pixels get the farthest value it reaches inside them
+		const float depthX = (edgeX[0] * z[0] + edgeX[1] * z[1] + edgeX[2] * z[2]) / area;
+		const float depthY = (edgeY[0] * z[0] + edgeY[1] * z[1] + edgeY[2] * z[2]) / area;
+		const float depthC = (edgeC[0] * z[0] + edgeC[1] * z[1] + edgeC[2] * z[2]) / area +
+			0.5f * (std::fabs(depthX) + std::fabs(depthY));
+
+		// pixels are centered on half coordinates
+		const int x0 = std::max(0, static_cast<int>(std::floor(std::min({ x[0], x[1], x[2] }))));
+		const int x1 = std::min(static_cast<int>(width) - 1, static_cast<int>(std::floor(std::max({ x[0], x[1], x[2] }))));
+		const int y0 = std::max(0, static_cast<int>(std::floor(std::min({ y[0], y[1], y[2] }))));
+		const int y1 = std::min(static_cast<int>(height) - 1, static_cast<int>(std::floor(std::max({ y[0], y[1], y[2] }))));
+		if (x0 > x1 || y0 > y1)
+			return;
+#ifdef FRUSTUM_CULLING_SSE
+		// 4 pixels at a time from a multiple of 4, width is one too so rows never run over
+		const __m128 steps = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+		__m128 stepX[3], stepY[3], stepC[3];
+		for (int e = 0; e < 3; e++)
+		{
+			stepX[e] = _mm_set1_ps(edgeX[e]); stepY[e] = _mm_set1_ps(edgeY[e]); stepC[e] = _mm_set1_ps(edgeC[e]);
+		}
+		const __m128 planeX = _mm_set1_ps(depthX), planeY = _mm_set1_ps(depthY), planeC = _mm_set1_ps(depthC);
+		for (int py = y0; py <= y1; py++)
+		{
+			int spanStart = x0, spanEnd = x1;
+			if (RowSpan(edgeX, edgeY, edgeC, py + 0.5f, spanStart, spanEnd) == false)
+				continue;
+			const __m128 centerY = _mm_set1_ps(py + 0.5f);
+			for (int px = spanStart & ~3; px <= spanEnd; px += 4)
+			{
+				const __m128 centerX = _mm_add_ps(_mm_set1_ps(static_cast<float>(px)), steps);
+				__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+				for (int e = 0; e < 3; e++)
+					inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_add_ps(
+						_mm_mul_ps(stepX[e], centerX), _mm_mul_ps(stepY[e], centerY)), stepC[e]), _mm_setzero_ps()));
+				if (_mm_movemask_ps(inside) == 0)
+					continue;
+				const __m128 farthest = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX, centerX), _mm_mul_ps(planeY, centerY)), planeC);
+				float* row = &depth[py * width + px];
+				const __m128 current = _mm_loadu_ps(row);
+				_mm_storeu_ps(row, _mm_or_ps(_mm_and_ps(inside, _mm_min_ps(current, farthest)), _mm_andnot_ps(inside, current)));
+			}
+		}
+#else
+		for (int py = y0; py <= y1; py++)
+		{
+			int spanStart = x0, spanEnd = x1;
+			if (RowSpan(edgeX, edgeY, edgeC, py + 0.5f, spanStart, spanEnd) == false)
+				continue;
+			for (int px = spanStart; px <= spanEnd; px++)
+			{
+				const float centerX = px + 0.5f, centerY = py + 0.5f;
+				bool inside = true;
+				for (int e = 0; e < 3; e++)
+					inside &= edgeX[e] * centerX + edgeY[e] * centerY + edgeC[e] >= 0;
+				if (inside)
+				{
+					float& pixel = depth[py * width + px];
+					pixel = std::min(pixel, depthX * centerX + depthY * centerY + depthC);
+				}
+			}
+		}
+#endif
+	}
+
+	// narrows [start, end] to the pixels of a row whose centers may be inside every edge, a pixel wider
+	// than needed on both sides since the edge tests decide. false when none of them can be
+	static bool RowSpan(const float edgeX[3], const float edgeY[3], const float edgeC[3], float centerY, int& start, int& end)
+	{
+		for (int e = 0; e < 3; e++)
+		{
+			const float rest = edgeY[e] * centerY + edgeC[e];
+			if (edgeX[e] == 0)
+			{
+				if (rest < 0)
+					return false;
+				continue;
+			}
+			// where the edge crosses the row, as a pixel whose center it runs through
+			const float crossing = -rest / edgeX[e] - 0.5f;
+			if (crossing < -1.0f || crossing > 1e6f)
+			{
+				// far off the buffer, one side of the row or the other
+				if ((edgeX[e] > 0) == (crossing > 0))
+					return false;
+				continue;
+			}
+			if (edgeX[e] > 0)
+				start = std::max(start, static_cast<int>(std::ceil(crossing)) - 1);
+			else
+				end = std::min(end, static_cast<int>(std::floor(crossing)) + 1);
+		}
+		return start <= end;
+	}
+};
+#endif
@@ -0,0 +1,59 @@
+#ifndef _PARALLELFOR_H_
+#define _PARALLELFOR_H_
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Runs task(i) for every i in [0, count) on the Gateware thread pool and waits for all of them.
+// Work is handed out in contiguous chunks, so any per-index output stays deterministic
+// no matter how many threads end up running it.
+// The calling thread claims chunks too, so the loop finishes even when the pool never gets to it:
+// every live GLog keeps one pool thread busy, and a nested ParallelFor waits from inside the pool.
+template<typename Task>
+inline void ParallelFor(unsigned count, Task&& task, unsigned chunkSize = 1)
+{
+	if (chunkSize == 0)
+		chunkSize = 1;
+	const unsigned chunkCount = (count + chunkSize - 1) / chunkSize;
+	unsigned helpers = std::thread::hardware_concurrency();
+	helpers = (helpers > 1) ? helpers - 1 : 0;
+	if (helpers > chunkCount - 1)
+		helpers = chunkCount - 1;
+	// outlives this call, helpers the pool starts late only find there is nothing left to claim.
+	// it owns the pool handle too, dropping that on this thread would wait for every helper to run
+	struct SHARED {
+		GW::SYSTEM::GConcurrent workers;
+		std::atomic<unsigned> next{ 0 };
+		unsigned finished = 0;
+		std::mutex lock;
+		std::condition_variable allFinished;
+	};
+	std::shared_ptr<SHARED> shared;
+	// not worth waking the pool (or it's unavailable), just run it here
+	if (count <= chunkSize || helpers == 0 || -(shared = std::make_shared<SHARED>())->workers.Create(true)) {
+		for (unsigned i = 0; i < count; ++i)
+			task(i);
+		return;
+	}
+	auto runChunks = [count, chunkSize, chunkCount](SHARED& state, auto& work) {
+		for (unsigned chunk = state.next++; chunk < chunkCount; chunk = state.next++) {
+			unsigned start = chunk * chunkSize;
+			unsigned end = (count - start < chunkSize) ? count : start + chunkSize;
+			for (unsigned i = start; i < end; ++i)
+				work(i);
+			std::lock_guard<std::mutex> guard(state.lock);
+			if (++state.finished == chunkCount)
+				state.allFinished.notify_all();
+		}
+	};
+	auto* work = &task;
+	for (unsigned h = 0; h < helpers; ++h)
+		shared->workers.BranchSingular([shared, runChunks, work]() { runChunks(*shared, *work); });
+	runChunks(*shared, task);
+	std::unique_lock<std::mutex> guard(shared->lock);
+	shared->allFinished.wait(guard, [&shared, chunkCount]() { return shared->finished == chunkCount; });
+}
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef _RADIXSORT_H_
+#define _RADIXSORT_H_
+#include <vector>
+#include <utility>
+
+// A 64 bit sort key and the index of whatever it orders
+struct SORT_KEY {
+	unsigned long long key;
+	unsigned index;
+};
+
+// Stable LSD radix sort on key, 8 bits per pass. One read builds the histograms of all 8 digits,
+// and passes where every key has the same digit are skipped, so keys that only differ in a few
+// bytes only pay for those. scratch is resized as needed and can be kept around between sorts.
+inline void RadixSort(std::vector<SORT_KEY>& items, std::vector<SORT_KEY>& scratch)
+{
+	const size_t count = items.size();
+	if (count < 2)
+		return;
+	scratch.resize(count);
+	size_t histograms[8][256] = {};
+	for (const SORT_KEY& item : items)
+		for (unsigned digit = 0; digit < 8; ++digit)
+			++histograms[digit][(item.key >> (digit * 8)) & 0xFF];
+	SORT_KEY* from = items.data();
+	SORT_KEY* to = scratch.data();
+	for (unsigned digit = 0; digit < 8; ++digit) {
+		size_t* offsets = histograms[digit];
+		const unsigned shift = digit * 8;
+		if (offsets[(from[0].key >> shift) & 0xFF] == count)
+			continue; // every key has this digit, order wouldn't change
+		size_t total = 0;
+		for (unsigned bucket = 0; bucket < 256; ++bucket) {
+			size_t bucketCount = offsets[bucket];
+			offsets[bucket] = total;
+			total += bucketCount;
+		}
+		for (size_t i = 0; i < count; ++i)
+			to[offsets[(from[i].key >> shift) & 0xFF]++] = from[i];
+		std::swap(from, to);
+	}
+	if (from != items.data())
+		items.swap(scratch);
+}
+#endif
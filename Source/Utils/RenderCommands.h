@@ -0,0 +1,149 @@
+#ifndef _RENDERCOMMANDS_H_
+#define _RENDERCOMMANDS_H_
+#include <vector>
+#include <cstring>
+
+// The few GPU calls a level frame is made of. DirX12RendererLogic submits them to its D3D12
+// command list, RecordingCommands keeps them in memory so a frame can be checked or timed without a GPU.
+class RenderCommands
+{
+public:
+	// per frame buffers the shaders read through root shader resource views
+	enum BUFFER : unsigned { TRANSFORM_BUFFER, MATERIAL_BUFFER, VISIBLE_BUFFER, BUFFER_COUNT };
+	// vertex & index buffer pairs, the level's 16 bit indices share its vertex buffer
+	enum GEOMETRY : unsigned { LEVEL_GEOMETRY, LEVEL_GEOMETRY_16BIT, MERGED_GEOMETRY, GEOMETRY_COUNT };
+
+	virtual ~RenderCommands() = default;
+	// copies size bytes to offset in the frame's copy of buffer
+	virtual void WriteBuffer(BUFFER buffer, unsigned frame, unsigned offset, const void* data, unsigned size) = 0;
+	virtual void SetShaderResource(unsigned parameter, BUFFER buffer, unsigned frame) = 0;
+	// sets count 32 bit values starting offset values into the parameter's constants
+	virtual void SetRootConstants(unsigned parameter, unsigned count, const void* data, unsigned offset) = 0;
+	virtual void SetGeometry(GEOMETRY geometry) = 0;
+	virtual void DrawIndexedInstanced(unsigned indexCount, unsigned instanceCount,
+		unsigned startIndex, int baseVertex, unsigned startInstance) = 0;
+};
+
+// Keeps every call in submission order. Buffer writes and root constants are copied into data,
+// so two recordings of the same frame compare equal byte for byte.
+class RecordingCommands : public RenderCommands
+{
+public:
+	enum TYPE : unsigned { WRITE_BUFFER, SHADER_RESOURCE, ROOT_CONSTANTS, SET_GEOMETRY, DRAW_INDEXED };
+	struct COMMAND {
+		TYPE type;
+		unsigned args[5]; // call arguments in order, unused ones are 0
+		unsigned dataOffset, dataSize; // bytes in data copied by WRITE_BUFFER & ROOT_CONSTANTS
+	};
+	std::vector<COMMAND> commands;
+	std::vector<unsigned char> data;
+
+	// forgets the recording but keeps its memory, recording the next frame won't allocate
+	void Clear()
+	{
+		commands.clear();
+		data.clear();
+	}
+
+	unsigned Count(TYPE type) const
+	{
+		unsigned count = 0;
+		for (const COMMAND& command : commands)
+			count += command.type == type;
+		return count;
+	}
+
+	// FNV-1a of everything recorded, equal for identical frames
+	unsigned long long Hash() const
+	{
+		unsigned long long hash = 14695981039346656037ull;
+		auto add = [&hash](const void* bytes, size_t size) {
+			for (size_t i = 0; i < size; ++i)
+				hash = (hash ^ static_cast<const unsigned char*>(bytes)[i]) * 1099511628211ull;
+		};
+		add(commands.data(), sizeof(COMMAND) * commands.size());
+		add(data.data(), data.size());
+		return hash;
+	}
+
+	void WriteBuffer(BUFFER buffer, unsigned frame, unsigned offset, const void* bytes, unsigned size) override
+	{
+		Record(WRITE_BUFFER, { buffer, frame, offset, size, 0 }, bytes, size);
+	}
+	void SetShaderResource(unsigned parameter, BUFFER buffer, unsigned frame) override
+	{
+		Record(SHADER_RESOURCE, { parameter, buffer, frame, 0, 0 }, nullptr, 0);
+	}
+	void SetRootConstants(unsigned parameter, unsigned count, const void* values, unsigned offset) override
+	{
+		Record(ROOT_CONSTANTS, { parameter, count, offset, 0, 0 }, values, count * 4);
+	}
+	void SetGeometry(GEOMETRY geometry) override
+	{
+		Record(SET_GEOMETRY, { geometry, 0, 0, 0, 0 }, nullptr, 0);
+	}
+	void DrawIndexedInstanced(unsigned indexCount, unsigned instanceCount,
+		unsigned startIndex, int baseVertex, unsigned startInstance) override
+	{
+		Record(DRAW_INDEXED, { indexCount, instanceCount, startIndex, static_cast<unsigned>(baseVertex), startInstance },
+			nullptr, 0);
+	}
+
+private:
+	struct ARGS { unsigned values[5]; };
+	void Record(TYPE type, ARGS args, const void* bytes, unsigned size)
+	{
+		COMMAND command = { type, {}, static_cast<unsigned>(data.size()), size };
+		std::memcpy(command.args, args.values, sizeof(command.args));
+		commands.push_back(command);
+		if (size > 0) {
+			data.resize(data.size() + size);
+			std::memcpy(data.data() + command.dataOffset, bytes, size);
+		}
+	}
+};
+
+// A frame recorded in chunks on several threads. Every chunk gets its own RenderCommands that
+// starts with nothing bound, and SubmitChunks hands them to the GPU in chunk order.
+class ParallelRenderCommands
+{
+public:
+	virtual ~ParallelRenderCommands() = default;
+	// readies count chunks, each may then be recorded by a different thread
+	virtual void BeginChunks(unsigned count) = 0;
+	virtual RenderCommands& Chunk(unsigned index) = 0;
+	// once every chunk is recorded, on the thread that called BeginChunks
+	virtual void SubmitChunks() = 0;
+};
+
+// Records each chunk on its own and appends them to submitted in chunk order.
+// Passing submitted to LevelDraw::RecordParallel as its commands too gives the whole frame in one recording.
+class RecordingChunks : public ParallelRenderCommands
+{
+public:
+	std::vector<RecordingCommands> chunks;
+	RecordingCommands submitted;
+
+	void BeginChunks(unsigned count) override
+	{
+		chunks.resize(count);
+		for (RecordingCommands& chunk : chunks)
+			chunk.Clear();
+	}
+	RenderCommands& Chunk(unsigned index) override
+	{
+		return chunks[index];
+	}
+	void SubmitChunks() override
+	{
+		for (const RecordingCommands& chunk : chunks) {
+			const unsigned dataStart = static_cast<unsigned>(submitted.data.size());
+			for (RecordingCommands::COMMAND command : chunk.commands) {
+				command.dataOffset += dataStart;
+				submitted.commands.push_back(command);
+			}
+			submitted.data.insert(submitted.data.end(), chunk.data.begin(), chunk.data.end());
+		}
+	}
+};
+#endif
@@ -0,0 +1,116 @@
+#ifndef _STRINGINTERNER_H_
+#define _STRINGINTERNER_H_
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstring>
+
+namespace H2B {
+
+	// Append-only pool that stores each distinct string once.
+	// Strings are bump allocated out of large blocks that never move, so every pointer handed out
+	// stays valid until Clear, even when the interner itself is moved.
+	class StringInterner
+	{
+		static constexpr size_t BLOCK_SIZE = 16 * 1024;
+		std::vector<std::unique_ptr<char[]>> blocks;
+		size_t blockUsed = 0, blockSize = 0; // of blocks.back()
+		// open addressing, the size is a power of two and kept at most half full
+		struct SLOT {
+			const char* str;
+			size_t hash;
+			size_t length;
+		};
+		std::vector<SLOT> slots;
+		size_t count = 0, bytes = 0;
+
+		static size_t Hash(const char* str, size_t length) {
+			unsigned long long hash = 14695981039346656037ull; // FNV-1a
+			for (size_t i = 0; i < length; ++i)
+				hash = (hash ^ static_cast<unsigned char>(str[i])) * 1099511628211ull;
+			return static_cast<size_t>(hash);
+		}
+		char* Allocate(size_t size) {
+			if (size > BLOCK_SIZE / 4) { // big strings get a block of their own, the open one stays last
+				blocks.emplace_back(new char[size]);
+				char* out = blocks.back().get();
+				if (blockSize != 0)
+					std::swap(blocks.back(), blocks[blocks.size() - 2]);
+				return out;
+			}
+			if (blocks.empty() || size > blockSize - blockUsed) {
+				blocks.emplace_back(new char[BLOCK_SIZE]);
+				blockUsed = 0;
+				blockSize = BLOCK_SIZE;
+			}
+			char* out = blocks.back().get() + blockUsed;
+			blockUsed += size;
+			return out;
+		}
+		void Grow() {
+			std::vector<SLOT> old(slots.empty() ? 64 : slots.size() * 2, SLOT{ nullptr, 0, 0 });
+			old.swap(slots);
+			const size_t mask = slots.size() - 1;
+			for (const SLOT& slot : old) {
+				if (slot.str == nullptr)
+					continue;
+				size_t i = slot.hash & mask;
+				while (slots[i].str != nullptr)
+					i = (i + 1) & mask;
+				slots[i] = slot;
+			}
+		}
+	public:
+		StringInterner() = default;
+		StringInterner(const StringInterner&) = delete;
+		StringInterner& operator=(const StringInterner&) = delete;
+		StringInterner(StringInterner&& other) noexcept { *this = std::move(other); }
+		StringInterner& operator=(StringInterner&& other) noexcept {
+			if (this != &other) {
+				blocks = std::move(other.blocks);
+				slots = std::move(other.slots);
+				blockUsed = other.blockUsed;
+				blockSize = other.blockSize;
+				count = other.count;
+				bytes = other.bytes;
+				other.Clear();
+			}
+			return *this;
+		}
+
+		// returns the pooled copy of str, adding it the first time it is seen
+		const char* Intern(const char* str, size_t length) {
+			if ((count + 1) * 2 > slots.size())
+				Grow();
+			const size_t hash = Hash(str, length);
+			const size_t mask = slots.size() - 1;
+			for (size_t i = hash & mask;; i = (i + 1) & mask) {
+				SLOT& slot = slots[i];
+				if (slot.str == nullptr) {
+					char* copy = Allocate(length + 1);
+					std::memcpy(copy, str, length);
+					copy[length] = '\0';
+					slot = { copy, hash, length };
+					++count;
+					bytes += length + 1;
+					return copy;
+				}
+				if (slot.hash == hash && slot.length == length && std::memcmp(slot.str, str, length) == 0)
+					return slot.str;
+			}
+		}
+		const char* Intern(const char* str) { return Intern(str, std::strlen(str)); }
+		const char* Intern(const std::string& str) { return Intern(str.data(), str.size()); }
+		// number of distinct strings and the bytes they take (terminators included)
+		size_t Count() const { return count; }
+		size_t Bytes() const { return bytes; }
+		// invalidates every pointer handed out so far
+		void Clear() {
+			blocks.clear();
+			slots.clear();
+			blockUsed = blockSize = 0;
+			count = bytes = 0;
+		}
+	};
+}
+#endif
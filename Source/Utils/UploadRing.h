@@ -0,0 +1,86 @@
+#ifndef _UPLOADRING_H_
+#define _UPLOADRING_H_
+#include <deque>
+#include <cstddef>
+
+// Hands out offsets into one persistently mapped upload buffer, oldest frames first in line to be reused.
+// Every frame's allocations follow the previous frame's and wrap back to the start of the buffer when
+// they don't fit before its end. A frame's bytes are only reused once the GPU fence value it was
+// finished with has been reached, so nothing here knows about the GPU beyond those fence values.
+class UploadRing
+{
+public:
+	static constexpr size_t INVALID_OFFSET = ~size_t(0);
+
+	// forgets every allocation, only call when the GPU no longer reads any of them
+	void Reset(size_t _capacity)
+	{
+		capacity = _capacity;
+		head = tail = used = frameUsed = 0;
+		frames.clear();
+	}
+
+	// offset of size free bytes aligned to alignment (a power of two), or INVALID_OFFSET when
+	// the frames the GPU hasn't finished with leave no room for it
+	size_t Allocate(size_t size, size_t alignment)
+	{
+		if (used == 0)
+			head = tail = 0; // nothing in flight, start over from the front
+		size_t offset = (head + alignment - 1) & ~(alignment - 1);
+		size_t skipped = offset - head;
+		if (head >= tail && (used == 0 || head != tail))
+		{
+			// free space runs from head to the end, then from the start to tail
+			if (offset + size > capacity)
+			{
+				if (size > tail)
+					return INVALID_OFFSET;
+				skipped = capacity - head; // the end of the buffer goes unused until tail passes it
+				offset = 0;
+			}
+		}
+		else if (offset + size > tail)
+			return INVALID_OFFSET; // wrapped, only the space up to tail is free
+		used += skipped + size;
+		frameUsed += skipped + size;
+		head = offset + size;
+		return offset;
+	}
+
+	// closes the current frame, its allocations come back once Retire sees fence completed
+	void FinishFrame(unsigned long long fence)
+	{
+		frames.push_back({ fence, head, frameUsed });
+		frameUsed = 0;
+	}
+
+	// reuses the space of every finished frame whose fence value is at most completedFence
+	void Retire(unsigned long long completedFence)
+	{
+		while (frames.empty() == false && frames.front().fence <= completedFence)
+		{
+			if (frames.front().bytes > 0) // an empty frame's end may predate Allocate starting over
+			{
+				tail = frames.front().end;
+				used -= frames.front().bytes;
+			}
+			frames.pop_front();
+		}
+	}
+
+	size_t Capacity() const { return capacity; }
+	// bytes the GPU may still read, alignment and the skipped end of the buffer included
+	size_t Used() const { return used; }
+	// finished frames still waiting on their fence
+	size_t FramesInFlight() const { return frames.size(); }
+
+private:
+	struct FRAME {
+		unsigned long long fence;
+		size_t end; // head once the frame was finished
+		size_t bytes; // used by the frame's allocations
+	};
+	size_t capacity = 0, head = 0, tail = 0, used = 0, frameUsed = 0;
+	std::deque<FRAME> frames;
+};
+#endif
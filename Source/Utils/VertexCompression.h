@@ -0,0 +1,163 @@
+#ifndef _VERTEXCOMPRESSION_H_
+#define _VERTEXCOMPRESSION_H_
+#include <cmath>
+#include <cstring>
+#include "h2bParser.h"
+
+namespace H2B {
+
+#pragma pack(push,1)
+	// 16 byte alternative to VERTEX (36 bytes), must match the COMPACT_VERTICES input layout
+	struct COMPACT_VERTEX {
+		unsigned short pos[4]; // R16G16B16A16_UNORM, xyz relative to the model's bounds
+		unsigned short uv[2]; // R16G16_FLOAT, uvw.z is dropped
+		short nrm[2]; // R16G16_SNORM, octahedral encoded unit normal
+	};
+#pragma pack(pop)
+	// position = offset + unorm * scale, with unorm in [0,1] as the input assembler reads it
+	struct QUANTIZATION {
+		VECTOR offset, scale;
+	};
+
+	// IEEE half precision conversion (round to nearest even)
+	inline unsigned short FloatToHalf(float value)
+	{
+		unsigned bits;
+		std::memcpy(&bits, &value, 4);
+		unsigned sign = (bits >> 16) & 0x8000;
+		unsigned exponent = (bits >> 23) & 0xFF;
+		unsigned mantissa = bits & 0x7FFFFF;
+		if (exponent == 0xFF) // infinity or NaN
+			return static_cast<unsigned short>(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+		int halfExponent = static_cast<int>(exponent) - 127 + 15;
+		if (halfExponent >= 31) // too big, clamp to infinity
+			return static_cast<unsigned short>(sign | 0x7C00);
+		if (halfExponent <= 0) { // denormal or zero
+			if (halfExponent < -10)
+				return static_cast<unsigned short>(sign);
+			mantissa |= 0x800000;
+			unsigned shift = 14 - halfExponent;
+			unsigned half = mantissa >> shift;
+			unsigned remainder = mantissa & ((1u << shift) - 1);
+			unsigned midpoint = 1u << (shift - 1);
+			if (remainder > midpoint || (remainder == midpoint && (half & 1)))
+				++half;
+			return static_cast<unsigned short>(sign | half);
+		}
+		unsigned half = (halfExponent << 10) | (mantissa >> 13);
+		unsigned remainder = mantissa & 0x1FFF;
+		if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+			++half; // may carry into the exponent, which rounds up correctly
+		return static_cast<unsigned short>(sign | half);
+	}
+	inline float HalfToFloat(unsigned short value)
+	{
+		unsigned sign = (value & 0x8000u) << 16;
+		unsigned exponent = (value >> 10) & 0x1F;
+		unsigned mantissa = value & 0x3FF;
+		unsigned bits;
+		if (exponent == 0x1F) // infinity or NaN
+			bits = sign | 0x7F800000 | (mantissa << 13);
+		else if (exponent != 0)
+			bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+		else if (mantissa == 0)
+			bits = sign;
+		else { // denormal, renormalize
+			exponent = 127 - 15 + 1;
+			while ((mantissa & 0x400) == 0) {
+				mantissa <<= 1;
+				--exponent;
+			}
+			bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+		}
+		float out;
+		std::memcpy(&out, &bits, 4);
+		return out;
+	}
+
+	// maps a unit vector onto an octahedron unfolded into [-1,1]^2
+	inline void OctEncode(VECTOR normal, short out[2])
+	{
+		float length = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+		if (length == 0.0f) {
+			out[0] = out[1] = 0; // no direction, decodes to +Z
+			return;
+		}
+		float x = normal.x / length, y = normal.y / length;
+		if (normal.z < 0.0f) { // fold the lower half over the diagonals
+			float foldX = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+			float foldY = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+			x = foldX;
+			y = foldY;
+		}
+		out[0] = static_cast<short>(std::lround(std::fmax(-1.0f, std::fmin(1.0f, x)) * 32767.0f));
+		out[1] = static_cast<short>(std::lround(std::fmax(-1.0f, std::fmin(1.0f, y)) * 32767.0f));
+	}
+	// same math as OctDecode in VertexShader.hlsl
+	inline VECTOR OctDecode(const short in[2])
+	{
+		VECTOR n;
+		n.x = std::fmax(in[0] / 32767.0f, -1.0f);
+		n.y = std::fmax(in[1] / 32767.0f, -1.0f);
+		n.z = 1.0f - std::fabs(n.x) - std::fabs(n.y);
+		float t = std::fmax(-n.z, 0.0f);
+		n.x += (n.x >= 0.0f) ? -t : t;
+		n.y += (n.y >= 0.0f) ? -t : t;
+		float length = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+		n.x /= length;
+		n.y /= length;
+		n.z /= length;
+		return n;
+	}
+
+	// fits the unorm16 position range to the bounds of the given vertices
+	inline QUANTIZATION ComputeQuantization(const VERTEX* vertices, unsigned count)
+	{
+		QUANTIZATION out = { { 0, 0, 0 }, { 0, 0, 0 } };
+		if (count == 0)
+			return out;
+		VECTOR min = vertices[0].pos, max = vertices[0].pos;
+		for (unsigned i = 1; i < count; ++i) {
+			min.x = std::fmin(min.x, vertices[i].pos.x);
+			min.y = std::fmin(min.y, vertices[i].pos.y);
+			min.z = std::fmin(min.z, vertices[i].pos.z);
+			max.x = std::fmax(max.x, vertices[i].pos.x);
+			max.y = std::fmax(max.y, vertices[i].pos.y);
+			max.z = std::fmax(max.z, vertices[i].pos.z);
+		}
+		out.offset = min;
+		out.scale = { max.x - min.x, max.y - min.y, max.z - min.z };
+		return out;
+	}
+	// worst case error: half a quantization step per axis, under 0.001 radians for normals,
+	// and half precision (11 bit mantissa) for uvs
+	inline COMPACT_VERTEX EncodeVertex(const VERTEX& vertex, const QUANTIZATION& quantization)
+	{
+		auto quantize = [](float value, float offset, float scale) {
+			if (scale == 0.0f)
+				return static_cast<unsigned short>(0); // flat axis, every value is the offset
+			float unorm = std::fmax(0.0f, std::fmin(1.0f, (value - offset) / scale));
+			return static_cast<unsigned short>(std::lround(unorm * 65535.0f));
+		};
+		COMPACT_VERTEX out;
+		out.pos[0] = quantize(vertex.pos.x, quantization.offset.x, quantization.scale.x);
+		out.pos[1] = quantize(vertex.pos.y, quantization.offset.y, quantization.scale.y);
+		out.pos[2] = quantize(vertex.pos.z, quantization.offset.z, quantization.scale.z);
+		out.pos[3] = 0;
+		out.uv[0] = FloatToHalf(vertex.uvw.x);
+		out.uv[1] = FloatToHalf(vertex.uvw.y);
+		OctEncode(vertex.nrm, out.nrm);
+		return out;
+	}
+	inline VERTEX DecodeVertex(const COMPACT_VERTEX& vertex, const QUANTIZATION& quantization)
+	{
+		VERTEX out;
+		out.pos.x = quantization.offset.x + (vertex.pos[0] / 65535.0f) * quantization.scale.x;
+		out.pos.y = quantization.offset.y + (vertex.pos[1] / 65535.0f) * quantization.scale.y;
+		out.pos.z = quantization.offset.z + (vertex.pos[2] / 65535.0f) * quantization.scale.z;
+		out.uvw = { HalfToFloat(vertex.uv[0]), HalfToFloat(vertex.uv[1]), 0.0f };
+		out.nrm = OctDecode(vertex.nrm);
+		return out;
+	}
+}
+#endif
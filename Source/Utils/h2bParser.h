@@ -2,7 +2,9 @@
 #define _H2BPARSER_H_
 #include <fstream>
 #include <vector>
-#include <set>
+#include <cstring>
+#include "MappedFile.h"
+#include "StringInterner.h"
 
 namespace H2B {
 
@@ -43,9 +45,21 @@ namespace H2B {
 		BATCH drawInfo;
 		unsigned materialIndex;
 	};
+	// read-only window over contiguous elements (C++17 has no std::span)
+	template<typename T>
+	struct Span {
+		const T* first = nullptr;
+		unsigned count = 0;
+		const T* data() const { return first; }
+		unsigned size() const { return count; }
+		bool empty() const { return count == 0; }
+		const T* begin() const { return first; }
+		const T* end() const { return first + count; }
+		const T& operator[](unsigned i) const { return first[i]; }
+	};
 	class Parser
 	{
-		std::set<std::string> file_strings;
+		StringInterner file_strings;
 	public:
 		char version[4];
 		unsigned vertexCount;
@@ -60,6 +74,13 @@ namespace H2B {
 		bool Parse(const char* h2bPath)
 		{
 			Clear();
+			return Parse(h2bPath, file_strings);
+		}
+		// same as above but strings go to a caller owned pool, so they outlive this parser
+		// and can be shared with other data without being copied again
+		bool Parse(const char* h2bPath, StringInterner& strings)
+		{
+			ClearData(); // file_strings may still back strings from an earlier Parse(h2bPath)
 			std::ifstream file;
 			char buffer[260] = { 0, };
 			file.open(h2bPath,	std::ios_base::in | 
@@ -88,8 +109,7 @@ namespace H2B {
 					*((&materials[i].name) + j) = nullptr;
 					file.getline(buffer, 260, '\0');
 					if (buffer[0] != '\0') {
-						auto last = file_strings.insert(buffer);
-						*((&materials[i].name) + j) = last.first->c_str();
+						*((&materials[i].name) + j) = strings.Intern(buffer);
 					}
 				}
 			}
@@ -101,8 +121,7 @@ namespace H2B {
 				meshes[i].name = nullptr;
 				file.getline(buffer, 260, '\0');
 				if (buffer[0] != '\0') {
-					auto last = file_strings.insert(buffer);
-					meshes[i].name = last.first->c_str();
+					meshes[i].name = strings.Intern(buffer);
 				}
 				file.read(reinterpret_cast<char*>(&meshes[i].drawInfo), 8);
 				file.read(reinterpret_cast<char*>(&meshes[i].materialIndex), 4);
@@ -110,9 +129,14 @@ namespace H2B {
 			return true;
 		}
 		void Clear()
+		{
+			ClearData();
+			file_strings.Clear();
+		}
+		// everything but the string pool
+		void ClearData()
 		{
 			*reinterpret_cast<unsigned*>(version) = 0;
-			file_strings.clear();
 			vertices.clear();
 			indices.clear();
 			materials.clear();
@@ -120,5 +144,131 @@ namespace H2B {
 			meshes.clear();
 		}
 	};
+	// Zero-copy alternative to Parser, the .h2b file is mapped and read in place.
+	// Fixed size arrays are exposed as spans over the mapping, material and mesh
+	// strings are only turned into pointers when a MATERIAL or MESH is requested.
+	// Every pointer handed out is only valid while the MappedParser is open.
+	class MappedParser
+	{
+		MappedFile file;
+		// start of each variable length record, found while validating
+		std::vector<const char*> materialRecords;
+		std::vector<const char*> meshRecords;
+		// returns the end of a null terminated string or nullptr if it is malformed
+		static const char* SkipString(const char* str, const char* end) {
+			size_t remaining = end - str;
+			// Parser reads strings with a 260 character buffer, keep the same limit
+			const void* terminator = std::memchr(str, '\0', remaining < 260 ? remaining : 260);
+			return terminator ? static_cast<const char*>(terminator) + 1 : nullptr;
+		}
+	public:
+		char version[4];
+		unsigned vertexCount;
+		unsigned indexCount;
+		unsigned materialCount;
+		unsigned meshCount;
+		Span<VERTEX> vertices;
+		Span<unsigned> indices;
+		Span<BATCH> batches;
+		bool Parse(const char* h2bPath)
+		{
+			Clear();
+			if (file.Open(h2bPath) == false)
+			{
+				std::cout << "Error: " << strerror(errno);
+				return false;
+			}
+			const char* read = reinterpret_cast<const char*>(file.Data());
+			const char* end = read + file.Size();
+			if (file.Size() < 20) {
+				Clear();
+				return false;
+			}
+			std::memcpy(version, read, 4);
+			if (version[1] < '1' || version[2] < '9' || version[3] < 'd') {
+				Clear();
+				return false;
+			}
+			std::memcpy(&vertexCount, read + 4, 4);
+			std::memcpy(&indexCount, read + 8, 4);
+			std::memcpy(&materialCount, read + 12, 4);
+			std::memcpy(&meshCount, read + 16, 4);
+			read += 20;
+			// vertices & indices are 4 byte aligned since a VERTEX is 36 bytes
+			if (static_cast<size_t>(end - read) < 36ull * vertexCount + 4ull * indexCount) {
+				Clear();
+				return false;
+			}
+			vertices = { reinterpret_cast<const VERTEX*>(read), vertexCount };
+			read += 36ull * vertexCount;
+			indices = { reinterpret_cast<const unsigned*>(read), indexCount };
+			read += 4ull * indexCount;
+			// walk the material records, 80 bytes of attributes then 10 strings
+			materialRecords.resize(materialCount);
+			for (unsigned i = 0; i < materialCount; ++i) {
+				materialRecords[i] = read;
+				read = (end - read < 80) ? nullptr : read + 80;
+				for (int j = 0; j < 10 && read != nullptr; ++j)
+					read = SkipString(read, end);
+				if (read == nullptr) {
+					Clear();
+					return false;
+				}
+			}
+			if (static_cast<size_t>(end - read) < 8ull * materialCount) {
+				Clear();
+				return false;
+			}
+			batches = { reinterpret_cast<const BATCH*>(read), materialCount };
+			read += 8ull * materialCount;
+			// mesh records are a name followed by a BATCH and a material index
+			meshRecords.resize(meshCount);
+			for (unsigned i = 0; i < meshCount; ++i) {
+				meshRecords[i] = read;
+				read = SkipString(read, end);
+				if (read == nullptr || end - read < 12) {
+					Clear();
+					return false;
+				}
+				read += 12;
+			}
+			return true;
+		}
+		// builds a MATERIAL whose strings point directly into the mapped file
+		MATERIAL GetMaterial(unsigned i) const
+		{
+			MATERIAL out = {};
+			const char* read = materialRecords[i];
+			std::memcpy(&out.attrib, read, 80);
+			read += 80;
+			for (int j = 0; j < 10; ++j) {
+				*((&out.name) + j) = (*read != '\0') ? read : nullptr;
+				read += std::strlen(read) + 1;
+			}
+			return out;
+		}
+		// builds a MESH whose name points directly into the mapped file
+		MESH GetMesh(unsigned i) const
+		{
+			MESH out;
+			const char* read = meshRecords[i];
+			out.name = (*read != '\0') ? read : nullptr;
+			read += std::strlen(read) + 1;
+			std::memcpy(&out.drawInfo, read, 8);
+			std::memcpy(&out.materialIndex, read + 8, 4);
+			return out;
+		}
+		void Clear()
+		{
+			*reinterpret_cast<unsigned*>(version) = 0;
+			vertexCount = indexCount = materialCount = meshCount = 0;
+			vertices = {};
+			indices = {};
+			batches = {};
+			materialRecords.clear();
+			meshRecords.clear();
+			file.Close();
+		}
+	};
 }
 #endif
\ No newline at end of file
@@ -1,12 +1,70 @@
+#ifndef _LVLDATA_H_
+#define _LVLDATA_H_
 #include "h2bParser.h"
+#include "VertexCompression.h"
+#include "IndexPacking.h"
+#include "MeshOptimizer.h"
+#include "Meshlets.h"
+#include "MeshSimplifier.h"
+#include "MeshBounds.h"
+#include "ParallelFor.h"
+#include <filesystem>
+#include <set>
+#include <string_view>
+#include <unordered_map>
+#include <cstdint>
+#include <charconv>
+#include <cstdio>
+#include <atomic>
+#include <memory>
 
 
 class Level_Data {
 
 
-	// transfered from parser
-	std::set<std::string> level_strings;
+	// every name the level uses, stored once (mapped parser strings die with their files)
+	H2B::StringInterner level_strings;
+	// when loaded from a baked package all strings point into this mapping
+	MappedFile levelPackage;
+	// the load running in the background for LoadLevelAsync, if any
+	struct ASYNC_LOAD;
+	std::unique_ptr<ASYNC_LOAD> asyncLoad;
+	// set on the level a background load is filling so it can report progress and see cancels
+	ASYNC_LOAD* loadStatus = nullptr;
 public:
+	// Optional processing done at load/bake time, baked packages remember which were applied
+	enum IMPORT_OPTIONS : unsigned {
+		IMPORT_DEFAULT = 0,
+		IMPORT_COMPACT_VERTICES = 1 << 0, // fills levelCompactVertices & levelQuantization
+		IMPORT_OPTIMIZE_MESHES = 1 << 1, // reorders triangles & vertices of each model for the vertex cache
+		IMPORT_WELD_VERTICES = 1 << 2, // merges duplicate vertices of each model (see weldEpsilon)
+		IMPORT_16BIT_INDICES = 1 << 3, // fills levelIndices16, levelIndices32 & levelPackedIndices
+		IMPORT_MESHLETS = 1 << 4, // fills levelMeshlets & levelMeshletRanges
+		IMPORT_LODS = 1 << 5, // fills levelMeshLods with simplified copies of each mesh (see lodRatio)
+		IMPORT_MERGE_STATIC = 1 << 6, // bakes single instance models into world space buckets (levelMergedBuckets)
+	};
+	// Where a LoadLevelAsync call is at, the stages run top to bottom (the package ones only when baking)
+	enum LOAD_STAGE : unsigned {
+		LOAD_IDLE = 0, // nothing was loaded in the background yet
+		LOAD_READING_PACKAGE, // mapping a baked package
+		LOAD_READING_LEVEL, // parsing the level text, done/total are bytes
+		LOAD_IMPORTING_MODELS, // reading .h2b files, done/total are models
+		LOAD_RESOLVING_HIERARCHY, // linking blender objects to their parents, done/total are objects
+		LOAD_PROCESSING, // applying IMPORT_OPTIONS, done/total are steps
+		LOAD_SAVING_PACKAGE, // writing the baked package for next time
+		LOAD_COMPLETE, LOAD_FAILED, LOAD_CANCELED, // finished, see FinishLoad
+	};
+	struct LOAD_PROGRESS
+	{
+		LOAD_STAGE stage;
+		unsigned done, total; // within the current stage only
+	};
+	struct LEVEL_CHANGES // what ReloadLevel did to the loaded level
+	{
+		std::vector<unsigned> movedTransforms; // levelTransforms that got a new matrix, nothing else changed
+		bool rebuilt; // objects or models came and went, every array may have changed
+		unsigned importedModels, reusedModels; // only counted when rebuilt
+	};
 	struct LEVEL_MODEL // one model in the level
 	{
 		const char* filename; // .h2b file data was pulled from
@@ -18,10 +76,36 @@ public:
 	{
 		unsigned modelIndex, transformStart, transformCount, flags; // flags optional
 	};
+	// MODEL_INSTANCES::flags
+	static constexpr unsigned INSTANCES_MERGED = 1 << 0; // drawn as part of levelMergedBuckets instead
+	struct MERGED_RANGE // one mesh of one merged object
+	{
+		unsigned indexOffset, indexCount; // relative to its bucket's indices
+		H2B::BOUNDS bounds; // world space
+	};
+	struct MERGED_BUCKET // every merged mesh using one material, drawn at once
+	{
+		unsigned material; // levelUniqueMaterials index
+		unsigned vertexStart, vertexCount, indexStart, indexCount; // indices are relative to vertexStart
+		unsigned rangeStart, rangeCount; // in levelMergedRanges
+		unsigned transformIndex; // identity matrix in levelTransforms, the vertices are already in world space
+		H2B::QUANTIZATION quantization; // for levelMergedCompactVertices
+	};
 	struct MATERIAL_TEXTURES // swaps string pointers for loaded texture offsets
 	{
 		unsigned int albedoIndex, roughnessIndex, metalIndex, normalIndex;
 	};
+	struct MESHLET_RANGE // which meshlets make up a mesh
+	{
+		unsigned meshletStart, meshletCount;
+	};
+	// LOD 0 is the mesh as exported, each one after keeps about lodRatio of the triangles before it
+	static constexpr unsigned LOD_COUNT = 4;
+	struct MESH_LOD // one level of detail of a mesh
+	{
+		unsigned indexOffset, indexCount; // same space as BATCH, relative to the model's indices
+		float error; // furthest a vertex of the original mesh is from this surface, in model units
+	};
 	struct BLENDER_OBJECT // *NEW* Used to track individual objects in blender
 	{
 		const char* blendername; // *NEW* name of model straight from blender (FLECS)
@@ -47,11 +131,51 @@ public:
 	std::vector<MODEL_INSTANCES> levelInstances;
 	// *NEW* each item from the blender scene graph
 	std::vector<BLENDER_OBJECT> blenderObjects;
+	// *OPTIONAL* 16 byte copy of levelVertices (same order) for IMPORT_COMPACT_VERTICES
+	std::vector<H2B::COMPACT_VERTEX> levelCompactVertices;
+	// *OPTIONAL* how to expand each model's compact positions (one per model)
+	std::vector<H2B::QUANTIZATION> levelQuantization;
+	// *OPTIONAL* levelIndices split by the narrowest format each model fits (same order)
+	std::vector<unsigned short> levelIndices16;
+	std::vector<unsigned> levelIndices32;
+	// *OPTIONAL* where each model's indices went in the arrays above (one per model)
+	std::vector<H2B::PACKED_INDICES> levelPackedIndices;
+	// *OPTIONAL* every mesh split into small clusters with culling bounds, grouped by mesh
+	std::vector<H2B::MESHLET> levelMeshlets;
+	// *OPTIONAL* where each mesh's meshlets are (same size as levelMeshes)
+	std::vector<MESHLET_RANGE> levelMeshletRanges;
+	// *OPTIONAL* LOD_COUNT entries per mesh (mesh * LOD_COUNT + lod), simplified indices follow each model's own
+	std::vector<MESH_LOD> levelMeshLods;
+	// box & sphere around every model and every mesh (same order as levelModels / levelMeshes)
+	std::vector<H2B::BOUNDS> levelModelBounds;
+	std::vector<H2B::BOUNDS> levelMeshBounds;
+	// levelMaterials index of each distinct material, identical materials from different models share one
+	std::vector<unsigned> levelUniqueMaterials;
+	// which levelUniqueMaterials entry each mesh uses (same size as levelMeshes)
+	std::vector<unsigned> levelMeshMaterials;
+	// *OPTIONAL* IMPORT_MERGE_STATIC geometry, LOD 0 of every single instance model pre-transformed to world space
+	std::vector<H2B::VERTEX> levelMergedVertices;
+	std::vector<H2B::COMPACT_VERTEX> levelMergedCompactVertices; // with IMPORT_COMPACT_VERTICES (same order)
+	std::vector<unsigned> levelMergedIndices;
+	std::vector<MERGED_BUCKET> levelMergedBuckets;
+	std::vector<MERGED_RANGE> levelMergedRanges;
+	// IMPORT_OPTIONS used to produce the currently loaded level
+	unsigned importOptions = IMPORT_DEFAULT;
+	// IMPORT_WELD_VERTICES tolerance per vertex component, 0 only merges bit-identical vertices
+	float weldEpsilon = 0.0f;
+	// IMPORT_LODS share of triangles each LOD keeps from the one before it
+	float lodRatio = 0.5f;
+	// IMPORT_MERGE_STATIC merges models placed at most this many times, more than that stay instanced
+	unsigned mergeInstanceLimit = 1;
+	// folder for per model caches of imported & processed .h2b data, empty turns the cache off.
+	// a model is only imported again when its file contents or the import settings change
+	std::string modelCacheFolder;
 
 	// Imports the default level txt format and collects all .h2b data
 	bool LoadLevel(const char* gameLevelPath,
 		const char* h2bFolderPath,
-		GW::SYSTEM::GLog log) {
+		GW::SYSTEM::GLog log,
+		unsigned options = IMPORT_DEFAULT) {
 		// What this does:
 		// Parse GameLevel.txt 
 		// For each model found in the file...
@@ -64,20 +188,428 @@ public:
 
 		UnloadLevel();// clear previous level data if there is any
 		if (ReadGameLevel(gameLevelPath, uniqueModels, log) == false) {
-			log.LogCategorized("ERROR", "Fatal error reading game level, aborting level load.");
-			return false;
+			if (LoadCanceled() == false)
+				log.LogCategorized("ERROR", "Fatal error reading game level, aborting level load.");
+			return CancelOrFail(log);
 		}
-		if (ReadAndCombineH2Bs(h2bFolderPath, uniqueModels, log) == false) {
-			log.LogCategorized("ERROR", "Fatal error combining H2B mesh data, aborting level load.");
-			return false;
+		importOptions = options;
+		// cached models arrive already processed, only the level wide steps are left for them
+		const bool cached = modelCacheFolder.empty() == false;
+		if ((cached ? ReadCachedH2Bs(h2bFolderPath, uniqueModels, log) :
+			ReadAndCombineH2Bs(h2bFolderPath, uniqueModels, log)) == false) {
+			if (LoadCanceled() == false)
+				log.LogCategorized("ERROR", "Fatal error combining H2B mesh data, aborting level load.");
+			return CancelOrFail(log);
 		}
+		if (RunImportSteps(cached ? importOptions & LEVEL_WIDE_OPTIONS : importOptions, log) == false)
+			return CancelOrFail(log);
+		FinishImport(log);
 		// level loaded into CPU ram
 		log.LogCategorized("EVENT", "GAME LEVEL WAS LOADED TO CPU [DATA ORIENTED]");
 		return true;
 	}
+	// Loads the baked package for this level if it is newer than its sources,
+	// otherwise imports the level normally and re-bakes the package for next time.
+	bool LoadLevelBaked(const char* gameLevelPath,
+		const char* h2bFolderPath,
+		const char* packagePath,
+		GW::SYSTEM::GLog log,
+		unsigned options = IMPORT_DEFAULT) {
+		if (IsLevelPackageCurrent(gameLevelPath, h2bFolderPath, packagePath, options) &&
+			LoadLevelPackage(packagePath, log))
+			return true;
+		if (LoadLevel(gameLevelPath, h2bFolderPath, log, options) == false)
+			return false;
+		ReportProgress(LOAD_SAVING_PACKAGE, 0, 1);
+		SaveLevelPackage(packagePath, log); // failing to bake is not fatal
+		return true;
+	}
+	// Starts loading a level on a background thread and returns right away, this level is untouched
+	// until FinishLoad swaps the result in. With a packagePath it loads like LoadLevelBaked.
+	// weldEpsilon, lodRatio and mergeInstanceLimit are copied when the load starts. Starting a new load cancels the last one.
+	bool LoadLevelAsync(const char* gameLevelPath,
+		const char* h2bFolderPath,
+		const char* packagePath,
+		GW::SYSTEM::GLog log,
+		unsigned options = IMPORT_DEFAULT) {
+		asyncLoad.reset(); // cancels and waits for a load that is still running
+		asyncLoad = std::make_unique<ASYNC_LOAD>();
+		ASYNC_LOAD* status = asyncLoad.get();
+		status->level = std::make_unique<Level_Data>();
+		status->level->weldEpsilon = weldEpsilon;
+		status->level->lodRatio = lodRatio;
+		status->level->mergeInstanceLimit = mergeInstanceLimit;
+		status->level->modelCacheFolder = modelCacheFolder;
+		status->level->loadStatus = status;
+		// the caller's strings may not outlive this call
+		std::string levelPath = gameLevelPath, modelPath = h2bFolderPath, package = packagePath ? packagePath : "";
+		try {
+			status->worker = std::thread([status, levelPath, modelPath, package, log, options]() {
+				Level_Data& level = *status->level;
+				bool loaded = package.empty() ?
+					level.LoadLevel(levelPath.c_str(), modelPath.c_str(), log, options) :
+					level.LoadLevelBaked(levelPath.c_str(), modelPath.c_str(), package.c_str(), log, options);
+				status->stage.store(loaded ? LOAD_COMPLETE : level.LoadCanceled() ? LOAD_CANCELED : LOAD_FAILED,
+					std::memory_order_release);
+			});
+		}
+		catch (const std::system_error&) {
+			log.LogCategorized("ERROR", "Unable to start a background level load.");
+			asyncLoad.reset();
+			lastLoadStage = LOAD_FAILED;
+			return false;
+		}
+		return true;
+	}
+	// Safe to call every frame, reports the running background load or how the last one ended
+	LOAD_PROGRESS GetLoadProgress() const {
+		if (asyncLoad == nullptr)
+			return { lastLoadStage, 0, 0 };
+		return { static_cast<LOAD_STAGE>(asyncLoad->stage.load(std::memory_order_acquire)),
+			asyncLoad->done.load(std::memory_order_relaxed), asyncLoad->total.load(std::memory_order_relaxed) };
+	}
+	// Asks the background load to stop at its next check, FinishLoad/WaitForLoad still need calling
+	void CancelLoad() {
+		if (asyncLoad != nullptr)
+			asyncLoad->canceled.store(true, std::memory_order_relaxed);
+	}
+	// Never blocks. Once the background load is done this replaces the current level with it in one step
+	// and returns true. A failed or canceled load leaves the current level alone and returns false.
+	bool FinishLoad() {
+		if (asyncLoad == nullptr)
+			return false;
+		LOAD_STAGE stage = static_cast<LOAD_STAGE>(asyncLoad->stage.load(std::memory_order_acquire));
+		if (stage != LOAD_COMPLETE && stage != LOAD_FAILED && stage != LOAD_CANCELED)
+			return false;
+		std::unique_ptr<ASYNC_LOAD> finished = std::move(asyncLoad);
+		if (finished->worker.joinable()) // WaitForLoad may have joined it already
+			finished->worker.join();
+		if (stage == LOAD_COMPLETE) {
+			*this = std::move(*finished->level); // also moves the string storage so no pointers change
+			loadStatus = nullptr;
+		}
+		lastLoadStage = stage;
+		return stage == LOAD_COMPLETE;
+	}
+	// Blocks until the background load is done then finishes it like FinishLoad
+	bool WaitForLoad() {
+		if (asyncLoad != nullptr && asyncLoad->worker.joinable())
+			asyncLoad->worker.join();
+		return FinishLoad();
+	}
+	// Brings the loaded level up to date with an edited level file without starting over.
+	// Objects are matched by blender name: when only their matrices changed those are patched in place,
+	// otherwise the level is rebuilt reusing every loaded model that is not in changedModelFiles.
+	// Leaves the level untouched and returns false if the new level can't be read or a load is running.
+	bool ReloadLevel(const char* gameLevelPath,
+		const char* h2bFolderPath,
+		GW::SYSTEM::GLog log,
+		LEVEL_CHANGES& outChanges,
+		const std::vector<std::string>& changedModelFiles = {}) {
+		outChanges = { {}, false, 0, 0 };
+		if (asyncLoad != nullptr)
+			return false; // the background load replaces this level anyway
+		Level_Data next;
+		next.weldEpsilon = weldEpsilon;
+		next.lodRatio = lodRatio;
+		next.mergeInstanceLimit = mergeInstanceLimit;
+		next.modelCacheFolder = modelCacheFolder;
+		next.importOptions = importOptions;
+		std::set<MODEL_ENTRY> models;
+		if (next.ReadGameLevel(gameLevelPath, models, log) == false)
+			return false;
+		if (PatchTransforms(models, changedModelFiles, outChanges.movedTransforms)) {
+			log.LogCategorized("MESSAGE", (std::string("Level Reloaded: ") +
+				std::to_string(outChanges.movedTransforms.size()) + " transforms changed").c_str());
+			return true;
+		}
+		// keep every model that is still in use and unchanged, they are already processed
+		std::unordered_map<std::string_view, unsigned> loadedModels;
+		for (unsigned m = 0; m < levelModels.size(); ++m)
+			loadedModels.emplace(levelModels[m].filename, m);
+		for (const std::string& file : changedModelFiles)
+			loadedModels.erase(file);
+		std::vector<const MODEL_ENTRY*> entries;
+		std::vector<const Level_Data*> sources;
+		std::vector<unsigned> sourceModels;
+		for (const MODEL_ENTRY& entry : models) {
+			auto loaded = loadedModels.find(entry.modelFile);
+			entries.push_back(&entry);
+			sources.push_back(loaded != loadedModels.end() ? this : nullptr);
+			sourceModels.push_back(loaded != loadedModels.end() ? loaded->second : 0);
+			outChanges.reusedModels += (loaded != loadedModels.end()) ? 1 : 0;
+		}
+		unsigned cacheFailures = 0;
+		if (next.CombineModels(h2bFolderPath, entries, sources, sourceModels, {}, cacheFailures, log) == false ||
+			next.RunImportSteps(importOptions & LEVEL_WIDE_OPTIONS, log) == false)
+			return false;
+		next.FinishImport(log);
+		outChanges.rebuilt = true;
+		outChanges.importedModels = static_cast<unsigned>(next.levelModels.size()) - outChanges.reusedModels;
+		*this = std::move(next); // also moves the string storage so no pointers change
+		log.LogCategorized("MESSAGE", (std::string("Level Reloaded: ") + std::to_string(outChanges.reusedModels) +
+			" models kept, " + std::to_string(outChanges.importedModels) + " imported").c_str());
+		return true;
+	}
+	// Offline bake step, imports the level and writes it out as a single package
+	bool BakeLevel(const char* gameLevelPath,
+		const char* h2bFolderPath,
+		const char* packagePath,
+		GW::SYSTEM::GLog log,
+		unsigned options = IMPORT_DEFAULT) {
+		return LoadLevel(gameLevelPath, h2bFolderPath, log, options) &&
+			SaveLevelPackage(packagePath, log);
+	}
+	// Writes the currently loaded level to one versioned binary blob.
+	// Every array is stored as-is, string pointers are replaced by offsets into one string table.
+	bool SaveLevelPackage(const char* packagePath, GW::SYSTEM::GLog log) const {
+		std::string strings(1, '\0'); // all unique strings back to back, offset 0 stays null
+		std::unordered_map<std::string, std::uintptr_t> stringOffsets;
+		auto pack = [&](const char*& str) {
+			if (str == nullptr)
+				return;
+			auto found = stringOffsets.emplace(str, strings.size());
+			if (found.second)
+				strings.append(str, std::strlen(str) + 1);
+			std::uintptr_t offset = found.first->second;
+			std::memcpy(&str, &offset, sizeof(str)); // stored in place of the pointer
+		};
+		// copies of the records that hold strings so their pointers can be swapped for offsets
+		std::vector<H2B::MATERIAL> materials = levelMaterials;
+		for (auto& m : materials) {
+			for (int k = 0; k < 10; ++k)
+				pack(*((&m.name) + k));
+		}
+		std::vector<H2B::MESH> meshes = levelMeshes;
+		for (auto& m : meshes)
+			pack(m.name);
+		std::vector<LEVEL_MODEL> models = levelModels;
+		for (auto& m : models)
+			pack(m.filename);
+		std::vector<BLENDER_OBJECT> objects = blenderObjects;
+		for (auto& o : objects)
+			pack(o.blendername);
+		// lay out each section one after the other
+		PACKAGE_HEADER header = {};
+		std::memcpy(header.magic, "WLVL", 4);
+		header.version = PACKAGE_VERSION;
+		header.options = importOptions;
+		header.weldEpsilon = weldEpsilon;
+		header.lodRatio = lodRatio;
+		header.mergeInstanceLimit = mergeInstanceLimit;
+		header.sourceHash = packageSourceHash;
+		const void* sources[PACKAGE_SECTION_COUNT] = {};
+		unsigned long long offset = sizeof(PACKAGE_HEADER);
+		auto layout = [&](PACKAGE_SECTIONS section, const void* data, size_t count, size_t stride) {
+			offset = (offset + 15) & ~15ull; // keep every array 16 byte aligned
+			header.sections[section] = { offset, count, stride };
+			sources[section] = data;
+			offset += count * stride;
+		};
+		layout(VERTICES, levelVertices.data(), levelVertices.size(), sizeof(H2B::VERTEX));
+		layout(INDICES, levelIndices.data(), levelIndices.size(), sizeof(unsigned));
+		layout(MATERIALS, materials.data(), materials.size(), sizeof(H2B::MATERIAL));
+		layout(TRANSFORMS, levelTransforms.data(), levelTransforms.size(), sizeof(GW::MATH::GMATRIXF));
+		layout(COLLIDERS, levelColliders.data(), levelColliders.size(), sizeof(GW::MATH::GOBBF));
+		layout(BATCHES, levelBatches.data(), levelBatches.size(), sizeof(H2B::BATCH));
+		layout(MESHES, meshes.data(), meshes.size(), sizeof(H2B::MESH));
+		layout(MODELS, models.data(), models.size(), sizeof(LEVEL_MODEL));
+		layout(INSTANCES, levelInstances.data(), levelInstances.size(), sizeof(MODEL_INSTANCES));
+		layout(OBJECTS, objects.data(), objects.size(), sizeof(BLENDER_OBJECT));
+		layout(COMPACT_VERTICES, levelCompactVertices.data(), levelCompactVertices.size(), sizeof(H2B::COMPACT_VERTEX));
+		layout(QUANTIZATION, levelQuantization.data(), levelQuantization.size(), sizeof(H2B::QUANTIZATION));
+		layout(INDICES16, levelIndices16.data(), levelIndices16.size(), sizeof(unsigned short));
+		layout(INDICES32, levelIndices32.data(), levelIndices32.size(), sizeof(unsigned));
+		layout(INDEX_PACKING, levelPackedIndices.data(), levelPackedIndices.size(), sizeof(H2B::PACKED_INDICES));
+		layout(MESHLETS, levelMeshlets.data(), levelMeshlets.size(), sizeof(H2B::MESHLET));
+		layout(MESHLET_RANGES, levelMeshletRanges.data(), levelMeshletRanges.size(), sizeof(MESHLET_RANGE));
+		layout(MESH_LODS, levelMeshLods.data(), levelMeshLods.size(), sizeof(MESH_LOD));
+		layout(MODEL_BOUNDS, levelModelBounds.data(), levelModelBounds.size(), sizeof(H2B::BOUNDS));
+		layout(MESH_BOUNDS, levelMeshBounds.data(), levelMeshBounds.size(), sizeof(H2B::BOUNDS));
+		layout(UNIQUE_MATERIALS, levelUniqueMaterials.data(), levelUniqueMaterials.size(), sizeof(unsigned));
+		layout(MESH_MATERIALS, levelMeshMaterials.data(), levelMeshMaterials.size(), sizeof(unsigned));
+		layout(MERGED_VERTICES, levelMergedVertices.data(), levelMergedVertices.size(), sizeof(H2B::VERTEX));
+		layout(MERGED_COMPACT_VERTICES, levelMergedCompactVertices.data(), levelMergedCompactVertices.size(),
+			sizeof(H2B::COMPACT_VERTEX));
+		layout(MERGED_INDICES, levelMergedIndices.data(), levelMergedIndices.size(), sizeof(unsigned));
+		layout(MERGED_BUCKETS, levelMergedBuckets.data(), levelMergedBuckets.size(), sizeof(MERGED_BUCKET));
+		layout(MERGED_RANGES, levelMergedRanges.data(), levelMergedRanges.size(), sizeof(MERGED_RANGE));
+		layout(STRINGS, strings.data(), strings.size(), 1);
+		// write everything out in one go
+		std::ofstream file(packagePath, std::ios_base::out |
+										std::ios_base::binary | std::ios_base::trunc);
+		if (file.is_open() == false) {
+			log.LogCategorized("ERROR", (std::string("Unable to write level package: ") + packagePath).c_str());
+			return false;
+		}
+		file.write(reinterpret_cast<const char*>(&header), sizeof(PACKAGE_HEADER));
+		const char padding[16] = { 0, };
+		for (int i = 0; i < PACKAGE_SECTION_COUNT; ++i) {
+			file.write(padding, header.sections[i].offset - file.tellp());
+			file.write(static_cast<const char*>(sources[i]),
+				header.sections[i].count * header.sections[i].stride);
+		}
+		if (file.good() == false) {
+			log.LogCategorized("ERROR", (std::string("Unable to write level package: ") + packagePath).c_str());
+			return false;
+		}
+		log.LogCategorized("MESSAGE", (std::string("Level Package Baked: ") + packagePath).c_str());
+		return true;
+	}
+	// Maps a baked package and adopts its arrays wholesale, strings are used in place.
+	// Each section is one bulk copy into its std::vector since the import steps, ReloadLevel and the
+	// renderer all work on the vectors, the mapping stays open for the strings.
+	bool LoadLevelPackage(const char* packagePath, GW::SYSTEM::GLog log) {
+		log.LogCategorized("EVENT", "LOADING BAKED GAME LEVEL [DATA ORIENTED]");
+		ReportProgress(LOAD_READING_PACKAGE, 0, 1);
+		UnloadLevel();// clear previous level data if there is any
+		if (levelPackage.Open(packagePath) == false) {
+			log.LogCategorized("ERROR", (std::string("Level package not found: ") + packagePath).c_str());
+			return false;
+		}
+		const unsigned char* base = levelPackage.Data();
+		PACKAGE_HEADER header;
+		bool valid = levelPackage.Size() >= sizeof(PACKAGE_HEADER);
+		if (valid) {
+			std::memcpy(&header, base, sizeof(PACKAGE_HEADER));
+			valid = std::memcmp(header.magic, "WLVL", 4) == 0 && header.version == PACKAGE_VERSION;
+		}
+		// every section must match this build's layout and lie inside the file
+		const size_t strides[PACKAGE_SECTION_COUNT] = {
+			sizeof(H2B::VERTEX), sizeof(unsigned), sizeof(H2B::MATERIAL),
+			sizeof(GW::MATH::GMATRIXF), sizeof(GW::MATH::GOBBF), sizeof(H2B::BATCH),
+			sizeof(H2B::MESH), sizeof(LEVEL_MODEL), sizeof(MODEL_INSTANCES),
+			sizeof(BLENDER_OBJECT), sizeof(H2B::COMPACT_VERTEX), sizeof(H2B::QUANTIZATION),
+			sizeof(unsigned short), sizeof(unsigned), sizeof(H2B::PACKED_INDICES),
+			sizeof(H2B::MESHLET), sizeof(MESHLET_RANGE), sizeof(MESH_LOD),
+			sizeof(H2B::BOUNDS), sizeof(H2B::BOUNDS), sizeof(unsigned), sizeof(unsigned),
+			sizeof(H2B::VERTEX), sizeof(H2B::COMPACT_VERTEX), sizeof(unsigned), sizeof(MERGED_BUCKET),
+			sizeof(MERGED_RANGE), 1
+		};
+		for (int i = 0; valid && i < PACKAGE_SECTION_COUNT; ++i) {
+			const PACKAGE_SECTION& section = header.sections[i];
+			valid = section.stride == strides[i] && section.offset <= levelPackage.Size() &&
+				section.count <= (levelPackage.Size() - section.offset) / section.stride;
+		}
+		if (valid == false) {
+			log.LogCategorized("ERROR", "Level package is corrupt or out of date, aborting package load.");
+			UnloadLevel();
+			return false;
+		}
+		auto adopt = [&](auto& outArray, PACKAGE_SECTIONS section) {
+			using T = typename std::decay_t<decltype(outArray)>::value_type;
+			const T* first = reinterpret_cast<const T*>(base + header.sections[section].offset);
+			outArray.assign(first, first + header.sections[section].count);
+		};
+		adopt(levelVertices, VERTICES);
+		adopt(levelIndices, INDICES);
+		adopt(levelMaterials, MATERIALS);
+		adopt(levelTransforms, TRANSFORMS);
+		adopt(levelColliders, COLLIDERS);
+		adopt(levelBatches, BATCHES);
+		adopt(levelMeshes, MESHES);
+		adopt(levelModels, MODELS);
+		adopt(levelInstances, INSTANCES);
+		adopt(blenderObjects, OBJECTS);
+		adopt(levelCompactVertices, COMPACT_VERTICES);
+		adopt(levelQuantization, QUANTIZATION);
+		adopt(levelIndices16, INDICES16);
+		adopt(levelIndices32, INDICES32);
+		adopt(levelPackedIndices, INDEX_PACKING);
+		adopt(levelMeshlets, MESHLETS);
+		adopt(levelMeshletRanges, MESHLET_RANGES);
+		adopt(levelMeshLods, MESH_LODS);
+		adopt(levelModelBounds, MODEL_BOUNDS);
+		adopt(levelMeshBounds, MESH_BOUNDS);
+		adopt(levelUniqueMaterials, UNIQUE_MATERIALS);
+		adopt(levelMeshMaterials, MESH_MATERIALS);
+		adopt(levelMergedVertices, MERGED_VERTICES);
+		adopt(levelMergedCompactVertices, MERGED_COMPACT_VERTICES);
+		adopt(levelMergedIndices, MERGED_INDICES);
+		adopt(levelMergedBuckets, MERGED_BUCKETS);
+		adopt(levelMergedRanges, MERGED_RANGES);
+		importOptions = header.options;
+		weldEpsilon = header.weldEpsilon;
+		lodRatio = header.lodRatio;
+		mergeInstanceLimit = header.mergeInstanceLimit;
+		packageSourceHash = header.sourceHash;
+		// swap the stored offsets back to pointers into the mapped string table
+		const char* strings = reinterpret_cast<const char*>(base + header.sections[STRINGS].offset);
+		const size_t stringsSize = header.sections[STRINGS].count;
+		auto unpack = [&](const char*& str) {
+			if (str == nullptr)
+				return true;
+			std::uintptr_t offset;
+			std::memcpy(&offset, &str, sizeof(str));
+			if (offset >= stringsSize ||
+				std::memchr(strings + offset, '\0', stringsSize - offset) == nullptr)
+				return false;
+			str = strings + offset;
+			return true;
+		};
+		for (auto& m : levelMaterials) {
+			for (int k = 0; k < 10; ++k)
+				valid = unpack(*((&m.name) + k)) && valid;
+		}
+		for (auto& m : levelMeshes)
+			valid = unpack(m.name) && valid;
+		for (auto& m : levelModels)
+			valid = unpack(m.filename) && valid;
+		for (auto& o : blenderObjects)
+			valid = unpack(o.blendername) && valid;
+		if (valid == false) {
+			log.LogCategorized("ERROR", "Level package has invalid strings, aborting package load.");
+			UnloadLevel();
+			return false;
+		}
+		log.LogCategorized("EVENT", "BAKED GAME LEVEL WAS LOADED TO CPU [DATA ORIENTED]");
+		return true;
+	}
+	// A package is current when it is newer than the level file and every model it references
+	bool IsLevelPackageCurrent(const char* gameLevelPath,
+		const char* h2bFolderPath,
+		const char* packagePath,
+		unsigned options = IMPORT_DEFAULT) const {
+		std::error_code error;
+		auto packageTime = std::filesystem::last_write_time(packagePath, error);
+		if (error || std::filesystem::last_write_time(gameLevelPath, error) > packageTime || error)
+			return false;
+		MappedFile package; // only the header and model names are touched
+		if (package.Open(packagePath) == false || package.Size() < sizeof(PACKAGE_HEADER))
+			return false;
+		PACKAGE_HEADER header;
+		std::memcpy(&header, package.Data(), sizeof(PACKAGE_HEADER));
+		if (std::memcmp(header.magic, "WLVL", 4) != 0 || header.version != PACKAGE_VERSION ||
+			header.options != options ||
+			((options & IMPORT_WELD_VERTICES) && header.weldEpsilon != weldEpsilon) ||
+			((options & IMPORT_LODS) && header.lodRatio != lodRatio) ||
+			((options & IMPORT_MERGE_STATIC) && header.mergeInstanceLimit != mergeInstanceLimit))
+			return false;
+		// check the source file of every model recorded in the package
+		const PACKAGE_SECTION& models = header.sections[MODELS];
+		const PACKAGE_SECTION& strings = header.sections[STRINGS];
+		if (models.stride != sizeof(LEVEL_MODEL) ||
+			models.offset + models.count * models.stride > package.Size() ||
+			strings.offset + strings.count > package.Size())
+			return false;
+		const std::string modelPath = h2bFolderPath;
+		for (unsigned long long i = 0; i < models.count; ++i) {
+			LEVEL_MODEL model;
+			std::memcpy(&model, package.Data() + models.offset + i * models.stride, sizeof(LEVEL_MODEL));
+			std::uintptr_t offset;
+			std::memcpy(&offset, &model.filename, sizeof(offset));
+			const char* filename = reinterpret_cast<const char*>(package.Data() + strings.offset + offset);
+			if (offset >= strings.count ||
+				std::memchr(filename, '\0', strings.count - offset) == nullptr ||
+				std::filesystem::last_write_time(modelPath + "/" + filename, error) > packageTime || error)
+				return false;
+		}
+		return true;
+	}
 	// used to wipe CPU level data between levels
 	void UnloadLevel() {
-		level_strings.clear();
+		levelPackage.Close();
+		level_strings.Clear();
 		levelVertices.clear();
 		levelIndices.clear();
 		levelMaterials.clear();
@@ -86,8 +618,460 @@ public:
 		levelMeshes.clear();
 		levelModels.clear();
 		levelTransforms.clear();
+		levelColliders.clear();
 		levelInstances.clear();
 		blenderObjects.clear();
+		levelCompactVertices.clear();
+		levelQuantization.clear();
+		levelIndices16.clear();
+		levelIndices32.clear();
+		levelPackedIndices.clear();
+		levelMeshlets.clear();
+		levelMeshletRanges.clear();
+		levelMeshLods.clear();
+		levelModelBounds.clear();
+		levelMeshBounds.clear();
+		levelUniqueMaterials.clear();
+		levelMeshMaterials.clear();
+		levelMergedVertices.clear();
+		levelMergedCompactVertices.clear();
+		levelMergedIndices.clear();
+		levelMergedBuckets.clear();
+		levelMergedRanges.clear();
+		importOptions = IMPORT_DEFAULT;
+		packageSourceHash = 0;
+	}
+	// Fills levelModelBounds & levelMeshBounds from the vertices and sizes each model's collider to fit
+	void ComputeLevelBounds() {
+		levelModelBounds.resize(levelModels.size());
+		levelMeshBounds.resize(levelMeshes.size());
+		ParallelFor(static_cast<unsigned>(levelModels.size()), [&](unsigned m) {
+			const LEVEL_MODEL& model = levelModels[m];
+			const H2B::VERTEX* vertices = levelVertices.data() + model.vertexStart;
+			levelModelBounds[m] = H2B::ComputeVertexBounds(vertices, model.vertexCount);
+			for (unsigned i = model.meshStart; i < model.meshStart + model.meshCount; ++i) {
+				const H2B::BATCH& range = levelMeshes[i].drawInfo;
+				levelMeshBounds[i] = H2B::ComputeIndexedBounds(
+					levelIndices.data() + model.indexStart + range.indexOffset, range.indexCount, vertices);
+			}
+			const H2B::BOUNDS& box = levelModelBounds[m];
+			GW::MATH::GOBBF& collider = levelColliders[model.colliderIndex];
+			collider.center = { box.center.x, box.center.y, box.center.z, 0 };
+			collider.extent = { (box.max.x - box.min.x) * 0.5f, (box.max.y - box.min.y) * 0.5f,
+				(box.max.z - box.min.z) * 0.5f, 0 };
+			collider.rotation = GW::MATH::GIdentityQuaternionF; // model space, so unrotated
+		});
+	}
+	// Finds the distinct materials of the level and points every mesh at one of them.
+	// Materials match when their attributes and texture maps do, the material name is ignored.
+	void DeduplicateMaterials(GW::SYSTEM::GLog log) {
+		auto hashMaterial = [](const H2B::MATERIAL& material) {
+			unsigned long long hash = 14695981039346656037ull; // FNV-1a
+			auto add = [&hash](const void* data, size_t size) {
+				for (size_t i = 0; i < size; ++i)
+					hash = (hash ^ static_cast<const unsigned char*>(data)[i]) * 1099511628211ull;
+			};
+			add(&material.attrib, sizeof(H2B::ATTRIBUTES));
+			for (int k = 1; k < 10; ++k) { // the texture maps follow the name
+				const char* map = *((&material.name) + k);
+				add(map ? map : "", map ? std::strlen(map) + 1 : 0);
+				add("|", 1); // keeps a missing map apart from an empty one
+			}
+			return hash;
+		};
+		auto sameMaterial = [](const H2B::MATERIAL& a, const H2B::MATERIAL& b) {
+			if (std::memcmp(&a.attrib, &b.attrib, sizeof(H2B::ATTRIBUTES)) != 0)
+				return false;
+			for (int k = 1; k < 10; ++k) {
+				const char* mapA = *((&a.name) + k);
+				const char* mapB = *((&b.name) + k);
+				if ((mapA == nullptr || mapB == nullptr) ? mapA != mapB : std::strcmp(mapA, mapB) != 0)
+					return false;
+			}
+			return true;
+		};
+		std::vector<unsigned> remap(levelMaterials.size()); // levelMaterials -> levelUniqueMaterials
+		std::unordered_multimap<unsigned long long, unsigned> seen;
+		levelUniqueMaterials.clear();
+		for (unsigned i = 0; i < levelMaterials.size(); ++i) {
+			const unsigned long long hash = hashMaterial(levelMaterials[i]);
+			auto candidates = seen.equal_range(hash);
+			auto match = std::find_if(candidates.first, candidates.second, [&](const auto& candidate) {
+				return sameMaterial(levelMaterials[levelUniqueMaterials[candidate.second]], levelMaterials[i]);
+			});
+			if (match != candidates.second)
+				remap[i] = match->second;
+			else {
+				remap[i] = static_cast<unsigned>(levelUniqueMaterials.size());
+				seen.emplace(hash, remap[i]);
+				levelUniqueMaterials.push_back(i);
+			}
+		}
+		levelMeshMaterials.assign(levelMeshes.size(), 0);
+		for (const LEVEL_MODEL& model : levelModels)
+			for (unsigned i = model.meshStart; i < model.meshStart + model.meshCount && model.materialCount > 0; ++i)
+				levelMeshMaterials[i] =
+					remap[model.materialStart + std::min(levelMeshes[i].materialIndex, model.materialCount - 1)];
+		log.LogCategorized("INFO", (std::string("Materials: ") + std::to_string(levelMaterials.size()) + " -> " +
+			std::to_string(levelUniqueMaterials.size()) + " unique").c_str());
+	}
+	// Bakes LOD 0 of every model placed no more than mergeInstanceLimit times into world space, one bucket
+	// per material. Models placed as a child of another object stay instanced.
+	// Those instances get INSTANCES_MERGED and each bucket draws in one call with the identity transform.
+	void MergeStaticGeometry(GW::SYSTEM::GLog log) {
+		levelMergedVertices.clear();
+		levelMergedCompactVertices.clear();
+		levelMergedIndices.clear();
+		levelMergedBuckets.clear();
+		levelMergedRanges.clear();
+		// transform & mesh of everything merged, by material
+		std::vector<std::vector<std::pair<unsigned, unsigned>>> materialMeshes(levelUniqueMaterials.size());
+		unsigned mergedInstances = 0, largestModel = 0;
+		std::vector<unsigned> transformModels(levelTransforms.size()); // which model each transform places
+		// children are stored relative to their parent, that matrix alone doesn't place them in the world
+		std::vector<char> children(levelTransforms.size(), 0);
+		for (const BLENDER_OBJECT& object : blenderObjects)
+			if (object.parentTransformIndex >= 0)
+				children[object.transformIndex] = 1;
+		for (MODEL_INSTANCES& instances : levelInstances) {
+			std::fill_n(transformModels.begin() + instances.transformStart, instances.transformCount,
+				instances.modelIndex);
+			if (instances.transformCount == 0 || instances.transformCount > mergeInstanceLimit)
+				continue; // instancing already draws all of them at once
+			const auto placed = children.begin() + instances.transformStart;
+			if (std::find(placed, placed + instances.transformCount, 1) != placed + instances.transformCount)
+				continue;
+			const LEVEL_MODEL& model = levelModels[instances.modelIndex];
+			for (unsigned i = model.meshStart; i < model.meshStart + model.meshCount; ++i)
+				for (unsigned t = 0; t < instances.transformCount; ++t)
+					materialMeshes[levelMeshMaterials[i]].push_back({ instances.transformStart + t, i });
+			instances.flags |= INSTANCES_MERGED;
+			largestModel = std::max(largestModel, model.vertexCount);
+			mergedInstances += instances.transformCount;
+		}
+		if (mergedInstances == 0)
+			return;
+		// same math as the vertex shader, normals go through the matrix too and get renormalized
+		auto toWorld = [](const GW::MATH::GMATRIXF& m, H2B::VERTEX v) {
+			const H2B::VECTOR p = v.pos, n = v.nrm;
+			v.pos = { p.x * m.row1.x + p.y * m.row2.x + p.z * m.row3.x + m.row4.x,
+				p.x * m.row1.y + p.y * m.row2.y + p.z * m.row3.y + m.row4.y,
+				p.x * m.row1.z + p.y * m.row2.z + p.z * m.row3.z + m.row4.z };
+			v.nrm = { n.x * m.row1.x + n.y * m.row2.x + n.z * m.row3.x,
+				n.x * m.row1.y + n.y * m.row2.y + n.z * m.row3.y,
+				n.x * m.row1.z + n.y * m.row2.z + n.z * m.row3.z };
+			const float length = std::sqrt(v.nrm.x * v.nrm.x + v.nrm.y * v.nrm.y + v.nrm.z * v.nrm.z);
+			if (length > 0)
+				v.nrm = { v.nrm.x / length, v.nrm.y / length, v.nrm.z / length };
+			return v;
+		};
+		const unsigned identity = static_cast<unsigned>(levelTransforms.size());
+		levelTransforms.push_back(GW::MATH::GIdentityMatrixF);
+		// each mesh only copies the vertices it uses, remapped through the newest stamp
+		std::vector<unsigned> remap(largestModel), stamp(largestModel, ~0u);
+		unsigned pass = 0;
+		for (unsigned material = 0; material < materialMeshes.size(); ++material) {
+			if (materialMeshes[material].empty())
+				continue;
+			MERGED_BUCKET bucket = {};
+			bucket.material = material;
+			bucket.vertexStart = static_cast<unsigned>(levelMergedVertices.size());
+			bucket.indexStart = static_cast<unsigned>(levelMergedIndices.size());
+			bucket.rangeStart = static_cast<unsigned>(levelMergedRanges.size());
+			bucket.transformIndex = identity;
+			for (const auto& placed : materialMeshes[material]) {
+				const GW::MATH::GMATRIXF world = levelTransforms[placed.first];
+				const LEVEL_MODEL& model = levelModels[transformModels[placed.first]];
+				const H2B::MESH& mesh = levelMeshes[placed.second];
+				const unsigned* indices = levelIndices.data() + model.indexStart + mesh.drawInfo.indexOffset;
+				const unsigned firstVertex = static_cast<unsigned>(levelMergedVertices.size());
+				MERGED_RANGE range;
+				range.indexOffset = static_cast<unsigned>(levelMergedIndices.size()) - bucket.indexStart;
+				range.indexCount = mesh.drawInfo.indexCount;
+				for (unsigned i = 0; i < mesh.drawInfo.indexCount; ++i) {
+					const unsigned v = indices[i];
+					if (stamp[v] != pass) {
+						stamp[v] = pass;
+						remap[v] = static_cast<unsigned>(levelMergedVertices.size()) - bucket.vertexStart;
+						levelMergedVertices.push_back(toWorld(world, levelVertices[model.vertexStart + v]));
+					}
+					levelMergedIndices.push_back(remap[v]);
+				}
+				range.bounds = H2B::ComputeVertexBounds(levelMergedVertices.data() + firstVertex,
+					static_cast<unsigned>(levelMergedVertices.size()) - firstVertex);
+				levelMergedRanges.push_back(range);
+				++pass;
+			}
+			bucket.vertexCount = static_cast<unsigned>(levelMergedVertices.size()) - bucket.vertexStart;
+			bucket.indexCount = static_cast<unsigned>(levelMergedIndices.size()) - bucket.indexStart;
+			bucket.rangeCount = static_cast<unsigned>(levelMergedRanges.size()) - bucket.rangeStart;
+			if (importOptions & IMPORT_COMPACT_VERTICES) {
+				const H2B::VERTEX* vertices = levelMergedVertices.data() + bucket.vertexStart;
+				bucket.quantization = H2B::ComputeQuantization(vertices, bucket.vertexCount);
+				for (unsigned v = 0; v < bucket.vertexCount; ++v)
+					levelMergedCompactVertices.push_back(H2B::EncodeVertex(vertices[v], bucket.quantization));
+			}
+			levelMergedBuckets.push_back(bucket);
+		}
+		log.LogCategorized("INFO", (std::string("Merged Static Geometry: ") + std::to_string(mergedInstances) +
+			" instances (" + std::to_string(levelMergedRanges.size()) + " meshes) into " +
+			std::to_string(levelMergedBuckets.size()) + " material buckets").c_str());
+	}
+	// Merges duplicate vertices within each model then closes the gaps left in levelVertices
+	void WeldVertices(GW::SYSTEM::GLog log) {
+		std::vector<unsigned> welded(levelModels.size());
+		ParallelFor(static_cast<unsigned>(levelModels.size()), [&](unsigned m) {
+			const LEVEL_MODEL& model = levelModels[m];
+			welded[m] = H2B::WeldVertices(levelVertices.data() + model.vertexStart, model.vertexCount,
+				levelIndices.data() + model.indexStart, model.indexCount, weldEpsilon);
+		});
+		// indices are relative to each model so only the vertex ranges move
+		unsigned vertexTotal = 0;
+		for (unsigned m = 0; m < levelModels.size(); ++m) {
+			LEVEL_MODEL& model = levelModels[m];
+			log.LogCategorized("INFO", (std::string("Welded ") + model.filename + ": " +
+				std::to_string(model.vertexCount) + " -> " + std::to_string(welded[m]) + " vertices").c_str());
+			std::copy(levelVertices.begin() + model.vertexStart,
+				levelVertices.begin() + model.vertexStart + welded[m], levelVertices.begin() + vertexTotal);
+			model.vertexStart = vertexTotal;
+			model.vertexCount = welded[m];
+			vertexTotal += welded[m];
+		}
+		log.LogCategorized("INFO", (std::string("Vertex Welding: ") + std::to_string(levelVertices.size()) +
+			" -> " + std::to_string(vertexTotal) + " vertices").c_str());
+		levelVertices.resize(vertexTotal);
+		levelVertices.shrink_to_fit();
+	}
+	// Simplifies every mesh into LOD_COUNT - 1 coarser copies, each one starting over from the exported mesh
+	// so its error is measured against the real surface. The new indices are appended to each model's own,
+	// existing draw ranges keep their offsets. A LOD that can't get any smaller repeats the one before it.
+	void BuildLods(GW::SYSTEM::GLog log) {
+		std::vector<std::vector<unsigned>> appended(levelModels.size());
+		levelMeshLods.assign(levelMeshes.size() * LOD_COUNT, { 0, 0, 0.0f });
+		ParallelFor(static_cast<unsigned>(levelModels.size()), [&](unsigned m) {
+			if (LoadCanceled())
+				return; // the whole level is about to be thrown away
+			const LEVEL_MODEL& model = levelModels[m];
+			const unsigned* indices = levelIndices.data() + model.indexStart;
+			for (unsigned i = 0; i < model.meshCount; ++i) {
+				const H2B::BATCH& drawInfo = levelMeshes[model.meshStart + i].drawInfo;
+				MESH_LOD* lods = levelMeshLods.data() + (model.meshStart + i) * LOD_COUNT;
+				lods[0] = { drawInfo.indexOffset, drawInfo.indexCount, 0.0f };
+				const bool inRange =
+					static_cast<unsigned long long>(drawInfo.indexOffset) + drawInfo.indexCount <= model.indexCount;
+				float target = static_cast<float>(drawInfo.indexCount / 3);
+				for (unsigned lod = 1; lod < LOD_COUNT; ++lod) {
+					lods[lod] = lods[lod - 1];
+					target *= lodRatio;
+					if (inRange == false)
+						continue;
+					std::vector<unsigned> simplified(indices + drawInfo.indexOffset,
+						indices + drawInfo.indexOffset + drawInfo.indexCount);
+					float error = H2B::SimplifyMesh(simplified, levelVertices.data() + model.vertexStart,
+						model.vertexCount, static_cast<unsigned>(target) * 3);
+					if (simplified.empty() || simplified.size() >= lods[lod - 1].indexCount)
+						continue;
+					// never report less error than a finer LOD so picking by error stays monotonic
+					lods[lod] = { model.indexCount + static_cast<unsigned>(appended[m].size()),
+						static_cast<unsigned>(simplified.size()), std::fmax(error, lods[lod - 1].error) };
+					appended[m].insert(appended[m].end(), simplified.begin(), simplified.end());
+				}
+			}
+		});
+		// rebuild levelIndices in model order with each model's LODs right after it
+		std::vector<unsigned> indices;
+		indices.reserve(levelIndices.size());
+		for (unsigned m = 0; m < levelModels.size(); ++m) {
+			LEVEL_MODEL& model = levelModels[m];
+			indices.insert(indices.end(), levelIndices.begin() + model.indexStart,
+				levelIndices.begin() + model.indexStart + model.indexCount);
+			indices.insert(indices.end(), appended[m].begin(), appended[m].end());
+			model.indexStart = static_cast<unsigned>(indices.size() - model.indexCount - appended[m].size());
+			model.indexCount += static_cast<unsigned>(appended[m].size());
+		}
+		log.LogCategorized("INFO", (std::string("Mesh LODs: ") + std::to_string(levelIndices.size()) +
+			" -> " + std::to_string(indices.size()) + " indices").c_str());
+		levelIndices.swap(indices);
+	}
+	// Reorders each mesh's triangles (within its BATCH range) for vertex cache reuse and overdraw,
+	// then each model's vertices for fetch locality. Draw ranges and vertex counts are unchanged.
+	void OptimizeMeshes(GW::SYSTEM::GLog log) {
+		std::vector<H2B::VERTEX_CACHE_STATS> before(levelModels.size()), after(levelModels.size());
+		ParallelFor(static_cast<unsigned>(levelModels.size()), [&](unsigned m) {
+			const LEVEL_MODEL& model = levelModels[m];
+			H2B::VERTEX* vertices = levelVertices.data() + model.vertexStart;
+			unsigned* indices = levelIndices.data() + model.indexStart;
+			before[m] = H2B::AnalyzeVertexCache(indices, model.indexCount, model.vertexCount);
+			// every range something may draw, triangles can only move within one of them
+			std::vector<H2B::BATCH> ranges;
+			for (unsigned i = 0; i < model.meshCount; ++i)
+				ranges.push_back(levelMeshes[model.meshStart + i].drawInfo);
+			for (unsigned i = 0; i < model.materialCount; ++i)
+				ranges.push_back(levelBatches[model.batchStart + i]);
+			for (unsigned i = 0; i < model.meshCount && levelMeshLods.empty() == false; ++i)
+				for (unsigned lod = 1; lod < LOD_COUNT; ++lod) {
+					const MESH_LOD& range = levelMeshLods[(model.meshStart + i) * LOD_COUNT + lod];
+					ranges.push_back({ range.indexCount, range.indexOffset });
+				}
+			std::sort(ranges.begin(), ranges.end(), [](const H2B::BATCH& a, const H2B::BATCH& b) {
+				return a.indexOffset < b.indexOffset ||
+					(a.indexOffset == b.indexOffset && a.indexCount < b.indexCount);
+			});
+			ranges.erase(std::unique(ranges.begin(), ranges.end(), [](const H2B::BATCH& a, const H2B::BATCH& b) {
+				return a.indexOffset == b.indexOffset && a.indexCount == b.indexCount;
+			}), ranges.end());
+			bool disjoint = true; // overlapping ranges would be scrambled for each other
+			for (unsigned i = 0; i < ranges.size(); ++i)
+				disjoint &= ranges[i].indexCount % 3 == 0 &&
+					static_cast<unsigned long long>(ranges[i].indexOffset) + ranges[i].indexCount <= model.indexCount &&
+					(i == 0 || ranges[i - 1].indexOffset + ranges[i - 1].indexCount <= ranges[i].indexOffset);
+			if (disjoint) {
+				for (const H2B::BATCH& range : ranges) {
+					H2B::OptimizeVertexCache(indices + range.indexOffset, range.indexCount, model.vertexCount);
+					H2B::OptimizeOverdraw(indices + range.indexOffset, range.indexCount, vertices, model.vertexCount);
+				}
+			}
+			H2B::OptimizeVertexFetch(vertices, model.vertexCount, indices, model.indexCount);
+			after[m] = H2B::AnalyzeVertexCache(indices, model.indexCount, model.vertexCount);
+		});
+		// triangle weighted totals so big models dominate like they do on the GPU
+		unsigned long long triangles = 0, missesBefore = 0, missesAfter = 0, used = 0;
+		for (unsigned m = 0; m < levelModels.size(); ++m) {
+			triangles += before[m].triangles;
+			used += before[m].vertices;
+			missesBefore += before[m].transforms;
+			missesAfter += after[m].transforms;
+		}
+		if (triangles == 0 || used == 0)
+			return;
+		char summary[128];
+		std::snprintf(summary, sizeof(summary), "Vertex Cache: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f",
+			missesBefore / double(triangles), missesAfter / double(triangles),
+			missesBefore / double(used), missesAfter / double(used));
+		log.LogCategorized("INFO", summary);
+	}
+	// Splits every mesh into meshlets, triangles stay where they are so draw ranges are unaffected
+	void BuildMeshlets(GW::SYSTEM::GLog log) {
+		std::vector<std::vector<H2B::MESHLET>> modelMeshlets(levelModels.size());
+		levelMeshletRanges.assign(levelMeshes.size(), { 0, 0 });
+		ParallelFor(static_cast<unsigned>(levelModels.size()), [&](unsigned m) {
+			const LEVEL_MODEL& model = levelModels[m];
+			for (unsigned i = 0; i < model.meshCount; ++i)
+				levelMeshletRanges[model.meshStart + i].meshletCount = H2B::BuildMeshlets(
+					levelIndices.data() + model.indexStart, levelMeshes[model.meshStart + i].drawInfo,
+					levelVertices.data() + model.vertexStart, model.vertexCount, modelMeshlets[m]);
+		});
+		// concatenate in model order so the result never depends on thread timing
+		levelMeshlets.clear();
+		for (unsigned m = 0; m < levelModels.size(); ++m) {
+			const LEVEL_MODEL& model = levelModels[m];
+			unsigned start = static_cast<unsigned>(levelMeshlets.size());
+			for (unsigned i = 0; i < model.meshCount; ++i) {
+				levelMeshletRanges[model.meshStart + i].meshletStart = start;
+				start += levelMeshletRanges[model.meshStart + i].meshletCount;
+			}
+			levelMeshlets.insert(levelMeshlets.end(), modelMeshlets[m].begin(), modelMeshlets[m].end());
+		}
+		log.LogCategorized("INFO", (std::string("Meshlets: ") + std::to_string(levelMeshlets.size()) +
+			" built for " + std::to_string(levelMeshes.size()) + " meshes").c_str());
+	}
+	// Builds the 16 byte vertex format, positions are quantized against each model's bounds
+	void CompressVertices(GW::SYSTEM::GLog log) {
+		levelCompactVertices.resize(levelVertices.size());
+		levelQuantization.resize(levelModels.size());
+		ParallelFor(static_cast<unsigned>(levelModels.size()), [&](unsigned m) {
+			const LEVEL_MODEL& model = levelModels[m];
+			const H2B::VERTEX* vertices = levelVertices.data() + model.vertexStart;
+			levelQuantization[m] = H2B::ComputeQuantization(vertices, model.vertexCount);
+			for (unsigned v = 0; v < model.vertexCount; ++v)
+				levelCompactVertices[model.vertexStart + v] =
+					H2B::EncodeVertex(vertices[v], levelQuantization[m]);
+		});
+		log.LogCategorized("INFO", (std::string("Compact Vertices: ") +
+			std::to_string(levelVertices.size() * sizeof(H2B::VERTEX)) + " bytes -> " +
+			std::to_string(levelCompactVertices.size() * sizeof(H2B::COMPACT_VERTEX)) + " bytes").c_str());
+	}
+	// Stores each model's indices as 16 bit whenever its vertex range allows it
+	void PackIndices(GW::SYSTEM::GLog log) {
+		levelIndices16.clear();
+		levelIndices32.clear();
+		levelPackedIndices.resize(levelModels.size());
+		for (unsigned m = 0; m < levelModels.size(); ++m)
+			levelPackedIndices[m] = H2B::PackIndices(levelIndices.data() + levelModels[m].indexStart,
+				levelModels[m].indexCount, levelIndices16, levelIndices32);
+		log.LogCategorized("INFO", (std::string("Packed Indices: ") +
+			std::to_string(levelIndices.size() * sizeof(unsigned)) + " bytes -> " +
+			std::to_string(levelIndices16.size() * sizeof(unsigned short) +
+				levelIndices32.size() * sizeof(unsigned)) + " bytes").c_str());
+	}
+	// Runs the optional import steps picked by options (IMPORT_OPTIONS) in the order they depend on each other.
+	// Returns false if a background load was canceled part way.
+	bool RunImportSteps(unsigned options, GW::SYSTEM::GLog log) {
+		using STEP = void (Level_Data::*)(GW::SYSTEM::GLog);
+		const std::pair<unsigned, STEP> steps[] = {
+			{ IMPORT_WELD_VERTICES, &Level_Data::WeldVertices },
+			{ IMPORT_LODS, &Level_Data::BuildLods },
+			{ IMPORT_OPTIMIZE_MESHES, &Level_Data::OptimizeMeshes },
+			{ IMPORT_MESHLETS, &Level_Data::BuildMeshlets },
+			{ IMPORT_COMPACT_VERTICES, &Level_Data::CompressVertices },
+			{ IMPORT_16BIT_INDICES, &Level_Data::PackIndices },
+		};
+		unsigned stepCount = 0, stepsDone = 0;
+		for (const auto& step : steps)
+			stepCount += (options & step.first) ? 1 : 0;
+		for (const auto& step : steps) {
+			if ((options & step.first) == 0)
+				continue;
+			ReportProgress(LOAD_PROCESSING, stepsDone++, stepCount);
+			if (LoadCanceled())
+				return false;
+			(this->*step.second)(log);
+		}
+		return LoadCanceled() == false;
+	}
+	// Copies one model's geometry, materials and per model import results out of another level.
+	// Its collider and instances are left to the caller. Level wide results (levelPackedIndices) are not copied.
+	void AppendModel(const Level_Data& source, unsigned modelIndex) {
+		const LEVEL_MODEL& from = source.levelModels[modelIndex];
+		LEVEL_MODEL model = from;
+		model.filename = level_strings.Intern(from.filename);
+		model.vertexStart = static_cast<unsigned>(levelVertices.size());
+		model.indexStart = static_cast<unsigned>(levelIndices.size());
+		model.materialStart = static_cast<unsigned>(levelMaterials.size());
+		model.batchStart = static_cast<unsigned>(levelBatches.size());
+		model.meshStart = static_cast<unsigned>(levelMeshes.size());
+		auto append = [](auto& to, const auto& from, size_t start, size_t count) {
+			to.insert(to.end(), from.begin() + start, from.begin() + start + count);
+		};
+		append(levelVertices, source.levelVertices, from.vertexStart, from.vertexCount);
+		append(levelIndices, source.levelIndices, from.indexStart, from.indexCount);
+		append(levelMaterials, source.levelMaterials, from.materialStart, from.materialCount);
+		append(levelBatches, source.levelBatches, from.batchStart, from.materialCount);
+		append(levelMeshes, source.levelMeshes, from.meshStart, from.meshCount);
+		// strings belong to the source level, this level keeps its own copies
+		for (unsigned i = model.materialStart; i < levelMaterials.size(); ++i)
+			for (int k = 0; k < 10; ++k) {
+				const char*& str = *((&levelMaterials[i].name) + k);
+				if (str != nullptr)
+					str = level_strings.Intern(str);
+			}
+		for (unsigned i = model.meshStart; i < levelMeshes.size(); ++i)
+			if (levelMeshes[i].name != nullptr)
+				levelMeshes[i].name = level_strings.Intern(levelMeshes[i].name);
+		// optional results, present when the source was imported with them
+		if (source.levelMeshLods.empty() == false)
+			append(levelMeshLods, source.levelMeshLods, from.meshStart * LOD_COUNT, from.meshCount * LOD_COUNT);
+		if (source.levelMeshletRanges.empty() == false)
+			for (unsigned i = 0; i < from.meshCount; ++i) {
+				const MESHLET_RANGE& range = source.levelMeshletRanges[from.meshStart + i];
+				levelMeshletRanges.push_back({ static_cast<unsigned>(levelMeshlets.size()), range.meshletCount });
+				append(levelMeshlets, source.levelMeshlets, range.meshletStart, range.meshletCount);
+			}
+		if (source.levelCompactVertices.empty() == false)
+			append(levelCompactVertices, source.levelCompactVertices, from.vertexStart, from.vertexCount);
+		if (source.levelQuantization.empty() == false)
+			levelQuantization.push_back(source.levelQuantization[modelIndex]);
+		levelModels.push_back(model);
 	}
 	// *NO RENDERING/GPU/DRAW LOGIC IN HERE PLEASE* 
 	// *DATA ORIENTED SHOULD AIM TO SEPERATE DATA FROM THE LOGIC THAT USES IT*
@@ -95,163 +1079,213 @@ public:
 	// You can use your chosen API to have one GPU buffer for each type of data.
 	// Then you loop through instances using the API features to draw each mesh only once.
 private:
+	// layout of a baked level package (bump the version whenever a stored struct changes)
+	static constexpr unsigned PACKAGE_VERSION = 11;
+	// bump whenever an import step changes its output so every model cache gets rebuilt
+	static constexpr unsigned MODEL_CACHE_VERSION = 1;
+	// options that work across models, model caches are stored without them
+	static constexpr unsigned LEVEL_WIDE_OPTIONS = IMPORT_16BIT_INDICES | IMPORT_MERGE_STATIC;
+	enum PACKAGE_SECTIONS {
+		VERTICES, INDICES, MATERIALS, TRANSFORMS, COLLIDERS, BATCHES,
+		MESHES, MODELS, INSTANCES, OBJECTS, COMPACT_VERTICES, QUANTIZATION,
+		INDICES16, INDICES32, INDEX_PACKING, MESHLETS, MESHLET_RANGES,
+		MESH_LODS, MODEL_BOUNDS, MESH_BOUNDS, UNIQUE_MATERIALS,
+		MESH_MATERIALS, MERGED_VERTICES, MERGED_COMPACT_VERTICES, MERGED_INDICES, MERGED_BUCKETS,
+		MERGED_RANGES, STRINGS, PACKAGE_SECTION_COUNT
+	};
+	struct PACKAGE_SECTION {
+		unsigned long long offset, count, stride; // in bytes from the start of the file
+	};
+	struct PACKAGE_HEADER {
+		char magic[4]; // "WLVL"
+		unsigned version;
+		unsigned options; // IMPORT_OPTIONS baked into the package
+		float weldEpsilon; // tolerance used by IMPORT_WELD_VERTICES
+		float lodRatio; // triangle ratio used by IMPORT_LODS
+		unsigned mergeInstanceLimit; // used by IMPORT_MERGE_STATIC
+		unsigned long long sourceHash; // content hash of the .h2b a model cache was built from, 0 for levels
+		PACKAGE_SECTION sections[PACKAGE_SECTION_COUNT];
+	};
+	// shared between LoadLevelAsync's thread and whoever polls it
+	struct ASYNC_LOAD {
+		std::atomic<unsigned> stage{ LOAD_IDLE }, done{ 0 }, total{ 0 };
+		std::atomic<bool> canceled{ false };
+		std::unique_ptr<Level_Data> level; // filled in the background, swapped in by FinishLoad
+		std::thread worker;
+		~ASYNC_LOAD() {
+			canceled.store(true, std::memory_order_relaxed);
+			if (worker.joinable())
+				worker.join();
+		}
+	};
+	// how the last background load that was finished ended
+	LOAD_STAGE lastLoadStage = LOAD_IDLE;
+	// PACKAGE_HEADER::sourceHash of the loaded package, or the one to save
+	unsigned long long packageSourceHash = 0;
+	// progress reporting for background loads, these do nothing for normal loads
+	void ReportProgress(LOAD_STAGE stage, unsigned done, unsigned total) {
+		if (loadStatus == nullptr)
+			return;
+		loadStatus->total.store(total, std::memory_order_relaxed);
+		loadStatus->done.store(done, std::memory_order_relaxed);
+		loadStatus->stage.store(stage, std::memory_order_release);
+	}
+	void ReportStepDone() {
+		if (loadStatus != nullptr)
+			loadStatus->done.fetch_add(1, std::memory_order_relaxed);
+	}
+	bool LoadCanceled() const {
+		return loadStatus != nullptr && loadStatus->canceled.load(std::memory_order_relaxed);
+	}
+	// level wide results every import ends with, after the import steps
+	void FinishImport(GW::SYSTEM::GLog log) {
+		ComputeLevelBounds();
+		DeduplicateMaterials(log);
+		if (importOptions & IMPORT_MERGE_STATIC)
+			MergeStaticGeometry(log);
+	}
+	// ends a load that can't continue, a canceled one leaves nothing half built behind
+	bool CancelOrFail(GW::SYSTEM::GLog log) {
+		if (LoadCanceled()) {
+			log.LogCategorized("EVENT", "GAME LEVEL LOAD CANCELED");
+			UnloadLevel();
+		}
+		return false;
+	}
 	// internal defintion for reading the GameLevel layout 
 	struct MODEL_ENTRY
 	{
 		std::string modelFile; // path to .h2b file
-		// *NEW* object aligned bounding box data: // LBN, LTN, LTF, LBF, RBN, RTN, RTF, RBF
-		GW::MATH2D::GVECTOR3F boundry[8];
-		mutable std::vector<std::string> blenderNames; // *NEW* names from blender
+		mutable std::vector<const char*> blenderNames; // *NEW* names from blender (in level_strings)
 		mutable std::vector<GW::MATH::GMATRIXF> instances; // where to draw
-		mutable std::vector<GW::MATH::GMATRIXF> parents; // the transform index of the blender objects parent, set to -1 if no parent
+		mutable std::vector<unsigned> objectIds; // order each blender object appeared in the level file
+		mutable std::vector<int> parents; // objectId of each blender object's parent, set to -1 if no parent
 		bool operator<(const MODEL_ENTRY& cmp) const {
 			return modelFile < cmp.modelFile; // you need this for std::set to work
 		}
-		// *NEW* converts the vec3 boundries to an OBB
-		GW::MATH::GOBBF ComputeOBB() const {
-			GW::MATH::GOBBF out = {
-				GW::MATH::GIdentityVectorF,
-				GW::MATH::GIdentityVectorF,
-				GW::MATH::GIdentityQuaternionF // initally unrotated (local space)
-			};
-			out.center.x = (boundry[0].x + boundry[4].x) * 0.5f;
-			out.center.y = (boundry[0].y + boundry[1].y) * 0.5f;
-			out.center.z = (boundry[0].z + boundry[2].z) * 0.5f;
-			out.extent.x = std::fabsf(boundry[0].x - boundry[4].x) * 0.5f;
-			out.extent.y = std::fabsf(boundry[0].y - boundry[1].y) * 0.5f;
-			out.extent.z = std::fabsf(boundry[0].z - boundry[2].z) * 0.5f;
-			return out;
-		}
 	};
+	// returns the next line in [read, end) without its line ending, false once the text runs out
+	static bool NextLine(const char*& read, const char* end, const char*& lineStart, const char*& lineEnd) {
+		if (read >= end)
+			return false;
+		lineStart = read;
+		const char* newline = static_cast<const char*>(std::memchr(read, '\n', end - read));
+		lineEnd = newline ? newline : end;
+		read = newline ? newline + 1 : end;
+		if (lineEnd > lineStart && lineEnd[-1] == '\r')
+			--lineEnd; // tolerate files saved with windows line endings
+		return true;
+	}
+	// reads the 4 floats inside the "( ... )" of one exported matrix row, any column alignment works
+	static bool ReadMatrixRow(const char* lineStart, const char* lineEnd, float* outRow) {
+		const char* read = static_cast<const char*>(std::memchr(lineStart, '(', lineEnd - lineStart));
+		if (read == nullptr)
+			return false;
+		++read;
+		for (int i = 0; i < 4; ++i) {
+			while (read < lineEnd && (*read == ' ' || *read == '\t' || *read == ','))
+				++read;
+			auto result = std::from_chars(read, lineEnd, outRow[i]);
+			if (result.ec != std::errc())
+				return false;
+			read = result.ptr;
+		}
+		return true;
+	}
 	// internal helper for reading the game level
 	bool ReadGameLevel(const char* gameLevelPath,
 		std::set<MODEL_ENTRY>& outModels,
 		GW::SYSTEM::GLog log) {
 		log.LogCategorized("MESSAGE", "Begin Reading Game Level Text File.");
-		GW::SYSTEM::GFile file;
-		file.Create();
-		if (-file.OpenTextRead(gameLevelPath)) {
+		// the whole file is mapped and walked once, nothing is read line by line from disk
+		MappedFile file;
+		if (file.Open(gameLevelPath) == false) {
 			log.LogCategorized(
 				"ERROR", (std::string("Game level not found: ") + gameLevelPath).c_str());
 			return false;
 		}
-		char linebuffer[1024];
-		GW::MATH::GMATRIXF* lastParentTransformPtr = nullptr;
-		while (+file.ReadLine(linebuffer, 1024, '\n'))
+		const char* read = reinterpret_cast<const char*>(file.Data());
+		const char* end = read + file.Size();
+		const char* lineStart;
+		const char* lineEnd;
+		const char header[] = "# Game Level Exporter";
+		if (NextLine(read, end, lineStart, lineEnd) == false ||
+			static_cast<size_t>(lineEnd - lineStart) < sizeof(header) - 1 ||
+			std::memcmp(lineStart, header, sizeof(header) - 1) != 0) {
+			log.LogCategorized("WARNING", "Game level is missing the exporter header, reading it anyway.");
+			read = reinterpret_cast<const char*>(file.Data());
+		}
+		// finds models without building a MODEL_ENTRY (and its vectors) for every object
+		std::unordered_map<std::string, std::set<MODEL_ENTRY>::iterator> modelLookup;
+		std::string modelFile;
+		// "  MESH" blocks are children of the last top level "MESH" block
+		GW::MATH::GMATRIXF lastParentTransform = GW::MATH::GIdentityMatrixF;
+		int lastParentObject = -1;
+		unsigned objectCount = 0, childCount = 0;
+		const char* start = read;
+		ReportProgress(LOAD_READING_LEVEL, 0, static_cast<unsigned>(end - start));
+		while (NextLine(read, end, lineStart, lineEnd))
 		{
-			// having to have this is a bug, need to have Read/ReadLine return failure at EOF
-			if (linebuffer[0] == '\0')
+			// skip indentation, a child block is an indented MESH
+			const char* keyword = lineStart;
+			while (keyword < lineEnd && *keyword == ' ')
+				++keyword;
+			if (lineEnd - keyword != 4 || std::memcmp(keyword, "MESH", 4) != 0)
+				continue;
+			const bool child = keyword != lineStart;
+			ReportProgress(LOAD_READING_LEVEL, static_cast<unsigned>(read - start), static_cast<unsigned>(end - start));
+			if (LoadCanceled())
+				return false;
+			// blender name, minus the same indentation
+			if (NextLine(read, end, lineStart, lineEnd) == false)
 				break;
-			if (std::strcmp(linebuffer, "MESH") == 0)
-			{
-				file.ReadLine(linebuffer, 1024, '\n');
-				std::string blenderName = linebuffer;
-				log.LogCategorized("INFO", (std::string("Model Detected: ") + blenderName).c_str());
-				// create the model file name from this (strip the .001)
-				MODEL_ENTRY add = { linebuffer };
-				add.modelFile = add.modelFile.substr(0, add.modelFile.find_last_of("."));
-				add.modelFile += ".h2b";
+			while (lineStart < lineEnd && *lineStart == ' ')
+				++lineStart;
+			// interned straight from the file, the level keeps this pointer
+			const std::string_view name(lineStart, lineEnd - lineStart);
+			const char* blenderName = level_strings.Intern(name.data(), name.size());
+			// create the model file name from this (strip the .001)
+			modelFile.assign(name.data(), std::min(name.find_last_of('.'), name.size()));
+			modelFile += ".h2b";
 
-				// now read the transform data as we will need that regardless
-				GW::MATH::GMATRIXF transform;
-				for (int i = 0; i < 4; ++i) {
-					file.ReadLine(linebuffer, 1024, '\n');
-					// read floats
-					std::sscanf(linebuffer + 13, "%f, %f, %f, %f",
-						&transform.data[0 + i * 4], &transform.data[1 + i * 4],
-						&transform.data[2 + i * 4], &transform.data[3 + i * 4]);
-				}
-				std::string loc = "Location: X ";
-				loc += std::to_string(transform.row4.x) + " Y " +
-					std::to_string(transform.row4.y) + " Z " + std::to_string(transform.row4.z);
-				log.LogCategorized("INFO", loc.c_str());
-
-				//// *NEW* finally read in the boundry data for this model
-				//for (int i = 0; i < 8; ++i) {
-				//	file.ReadLine(linebuffer, 1024, '\n');
-				//	// read floats
-				//	std::sscanf(linebuffer + 9, "%f, %f, %f",
-				//		&add.boundry[i].x, &add.boundry[i].y, &add.boundry[i].z);
-				//}
-				//std::string bounds = "Boundry: Left ";
-				//bounds += std::to_string(add.boundry[0].x) +
-				//" Right " +	std::to_string(add.boundry[4].x) +
-				//" Bottom " + std::to_string(add.boundry[0].y) +
-				//" Top " + std::to_string(add.boundry[1].y) +
-				//" Near " + std::to_string(add.boundry[0].z) +
-				//" Far " + std::to_string(add.boundry[2].z);
-				//log.LogCategorized("INFO", bounds.c_str());
-
-				// does this model already exist?
-				auto found = outModels.find(add);
-				if (found == outModels.end()) // no
-				{
-					add.blenderNames.push_back(blenderName); // *NEW*
-					add.instances.push_back(transform);
-					add.parents.push_back(GW::MATH::GIdentityMatrixF);
-					outModels.insert(add);
-					lastParentTransformPtr = &transform;
-				}
-				else // yes
-				{
-					found->blenderNames.push_back(blenderName); // *NEW*
-					found->instances.push_back(transform);
-					found->parents.push_back(GW::MATH::GIdentityMatrixF);
-					lastParentTransformPtr = &transform;
+			// now read the transform data as we will need that regardless
+			GW::MATH::GMATRIXF transform;
+			for (int i = 0; i < 4; ++i) {
+				if (NextLine(read, end, lineStart, lineEnd) == false ||
+					ReadMatrixRow(lineStart, lineEnd, &transform.data[i * 4]) == false) {
+					log.LogCategorized("ERROR", (std::string("Malformed transform for: ") + blenderName).c_str());
+					return false;
 				}
 			}
-			else if (std::strcmp(linebuffer, "  MESH") == 0)
+			// children are stored relative to their parent (a child with no parent stays as is)
+			int parent = -1;
+			if (child && lastParentObject >= 0) {
+				GW::MATH::GMatrix::MakeRelativeF(transform, lastParentTransform, transform);
+				parent = lastParentObject;
+			}
+			// does this model already exist?
+			auto found = modelLookup.find(modelFile);
+			if (found == modelLookup.end()) // no
 			{
-				file.ReadLine(linebuffer, 1024, '\n');
-				std::string blenderName = std::string(linebuffer).substr(2);
-				log.LogCategorized("INFO", (std::string("Model Detected: ") + blenderName).c_str());
-				// create the model file name from this (strip the .001)
-				MODEL_ENTRY add = { std::string(linebuffer).substr(2).c_str() };
-				add.modelFile = add.modelFile.substr(0, add.modelFile.find_last_of("."));
-				add.modelFile += ".h2b";
-
-				// now read the transform data as we will need that regardless
-				GW::MATH::GMATRIXF transform;
-				for (int i = 0; i < 4; ++i) {
-					file.ReadLine(linebuffer, 1024, '\n');
-					// read floats
-					if (i == 0)
-					{
-						std::sscanf(linebuffer + 15, "%f, %f, %f, %f",
-							&transform.data[0 + i * 4], &transform.data[1 + i * 4],
-							&transform.data[2 + i * 4], &transform.data[3 + i * 4]);
-					}
-					else if (i >= 1)
-					{
-						std::sscanf(linebuffer + 13, "%f, %f, %f, %f",
-							&transform.data[0 + i * 4], &transform.data[1 + i * 4],
-							&transform.data[2 + i * 4], &transform.data[3 + i * 4]);
-					}
-				}
-				std::string loc = "Location: X ";
-				loc += std::to_string(transform.row4.x) + " Y " +
-					std::to_string(transform.row4.y) + " Z " + std::to_string(transform.row4.z);
-				log.LogCategorized("INFO", loc.c_str());
-
-				//Does this model already exist?
-				auto found = outModels.find(add);
-				if (found == outModels.end()) // no
-				{
-					GW::MATH::GMatrix::MakeRelativeF(transform, *lastParentTransformPtr, transform);
-					add.blenderNames.push_back(blenderName); // *NEW*
-					add.instances.push_back(transform);
-					add.parents.push_back(*lastParentTransformPtr);
-					outModels.insert(add);
-				}
-				else // yes
-				{
-					GW::MATH::GMatrix::MakeRelativeF(transform, *lastParentTransformPtr, transform);
-					found->blenderNames.push_back(blenderName); // *NEW*
-					found->instances.push_back(transform);
-					found->parents.push_back(*lastParentTransformPtr);
-				}
+				MODEL_ENTRY add = { modelFile };
+				found = modelLookup.emplace(modelFile, outModels.insert(add).first).first;
+			}
+			found->second->blenderNames.push_back(blenderName); // *NEW*
+			found->second->instances.push_back(transform);
+			found->second->objectIds.push_back(objectCount);
+			found->second->parents.push_back(parent);
+			if (child == false) {
+				lastParentTransform = transform;
+				lastParentObject = objectCount;
 			}
+			else
+				++childCount;
+			++objectCount;
 		}
+		// one summary instead of a log line per object
+		log.LogCategorized("INFO", (std::string("Objects Detected: ") + std::to_string(objectCount) +
+			" (" + std::to_string(childCount) + " children) using " +
+			std::to_string(outModels.size()) + " unique models").c_str());
 		log.LogCategorized("MESSAGE", "Game Level File Reading Complete.");
 		return true;
 	}
@@ -260,71 +1294,62 @@ private:
 		const std::set<MODEL_ENTRY>& modelSet,
 		GW::SYSTEM::GLog log) {
 		log.LogCategorized("MESSAGE", "Begin Importing .H2B File Data.");
-		// parse each model adding to overall arrays
-		H2B::Parser p; // reads the .h2b format
 		const std::string modelPath = h2bFolderPath;
+		std::vector<const MODEL_ENTRY*> entries;
+		entries.reserve(modelSet.size());
 		for (auto i = modelSet.begin(); i != modelSet.end(); ++i)
+			entries.push_back(&(*i));
+		// parse every model at once, each parser maps its own file (no intermediate copies)
+		std::vector<H2B::MappedParser> parsers(entries.size());
+		std::vector<char> parsed(entries.size()); // std::vector<bool> is not thread safe
+		ReportProgress(LOAD_IMPORTING_MODELS, 0, static_cast<unsigned>(entries.size()));
+		ParallelFor(static_cast<unsigned>(entries.size()), [&](unsigned i) {
+			if (LoadCanceled())
+				return;
+			parsed[i] = parsers[i].Parse((modelPath + "/" + entries[i]->modelFile).c_str());
+			ReportStepDone();
+		});
+		if (LoadCanceled())
+			return false;
+		// prefix sum of every array so each model knows where its data lands
+		std::vector<unsigned> modelSources; // which parser filled each level model
+		// parent links are resolved through each object's place in the level file
+		unsigned objectCount = 0;
+		for (const MODEL_ENTRY* i : entries)
+			objectCount += static_cast<unsigned>(i->objectIds.size());
+		std::vector<int> objectTransforms(objectCount, -1); // objectId -> transform index
+		std::vector<int> objectParents; // parent objectId of each entry in blenderObjects
+		objectParents.reserve(objectCount);
+		unsigned vertexTotal = 0, indexTotal = 0, materialTotal = 0, batchTotal = 0, meshTotal = 0;
+		for (unsigned e = 0; e < entries.size(); ++e)
 		{
-			if (p.Parse((modelPath + "/" + i->modelFile).c_str()))
+			const MODEL_ENTRY* i = entries[e];
+			const H2B::MappedParser& p = parsers[e];
+			if (parsed[e])
 			{
 				log.LogCategorized("INFO", (std::string("H2B Imported: ") + i->modelFile).c_str());
-				// transfer all string data
-				for (int j = 0; j < p.materialCount; ++j) {
-					for (int k = 0; k < 10; ++k) {
-						if (*((&p.materials[j].name) + k) != nullptr)
-							*((&p.materials[j].name) + k) =
-							level_strings.insert(*((&p.materials[j].name) + k)).first->c_str();
-					}
-				}
-				for (int j = 0; j < p.meshCount; ++j) {
-					if (p.meshes[j].name != nullptr)
-						p.meshes[j].name =
-						level_strings.insert(p.meshes[j].name).first->c_str();
-				}
 				// record source file name & sizes
 				LEVEL_MODEL model;
-				model.filename = level_strings.insert(i->modelFile).first->c_str();
+				model.filename = level_strings.Intern(i->modelFile);
 				model.vertexCount = p.vertexCount;
 				model.indexCount = p.indexCount;
 				model.materialCount = p.materialCount;
 				model.meshCount = p.meshCount;
 				// record offsets
-				model.vertexStart = levelVertices.size();
-				model.indexStart = levelIndices.size();
-				model.materialStart = levelMaterials.size();
-				model.batchStart = levelBatches.size();
-				model.meshStart = levelMeshes.size();
-				// append/move all data
-				levelVertices.insert(levelVertices.end(), p.vertices.begin(), p.vertices.end());
-				levelIndices.insert(levelIndices.end(), p.indices.begin(), p.indices.end());
-				levelMaterials.insert(levelMaterials.end(), p.materials.begin(), p.materials.end());
-				levelBatches.insert(levelBatches.end(), p.batches.begin(), p.batches.end());
-				levelMeshes.insert(levelMeshes.end(), p.meshes.begin(), p.meshes.end());
-				// *NEW* add overall collision volume(OBB) for this model and it's submeshes 
-				model.colliderIndex = levelColliders.size();
-				levelColliders.push_back(i->ComputeOBB());
+				model.vertexStart = vertexTotal;
+				model.indexStart = indexTotal;
+				model.materialStart = materialTotal;
+				model.batchStart = batchTotal;
+				model.meshStart = meshTotal;
+				vertexTotal += p.vertexCount;
+				indexTotal += p.indexCount;
+				materialTotal += p.materialCount;
+				batchTotal += p.materialCount;
+				meshTotal += p.meshCount;
 				// add level model
 				levelModels.push_back(model);
-				// add level model instances
-				MODEL_INSTANCES instances;
-				instances.flags = 0; // shadows? transparency? much we could do with this.
-				instances.modelIndex = levelModels.size() - 1;
-				instances.transformStart = levelTransforms.size();
-				instances.transformCount = i->instances.size();
-				levelTransforms.insert(levelTransforms.end(), i->instances.begin(), i->instances.end());
-				// add instance set
-				levelInstances.push_back(instances);
-				
-				// *NEW* Add an entry for each unique blender object
-				int offset = 0;
-				for (int j = 0; j < i->blenderNames.size(); j++)
-				{										
-					BLENDER_OBJECT obj{
-						level_strings.insert(i->blenderNames[j]).first->c_str(),
-						instances.modelIndex, instances.transformStart + offset++
-					};
-					blenderObjects.push_back(obj);
-				}
+				modelSources.push_back(e);
+				AddModelInstances(*i, objectTransforms, objectParents);
 			}
 			else {
 				// notify user that a model file is missing but continue loading
@@ -333,25 +1358,288 @@ private:
 				log.LogCategorized("WARNING", "Loading will continue but model(s) are missing.");
 			}
 		}
-		int counter = 0;
-		for (auto i = modelSet.begin(); i != modelSet.end(); ++i)
-		{
-			for (int j = 0; j < i->blenderNames.size(); j++)
-			{
-				blenderObjects[counter].parentTransformIndex = -1;
-				for (int t = 0; t < levelTransforms.size(); t++)
-				{
-					if (i->parents[j].row4.data[0] == levelTransforms[t].row4.data[0] &&
-						i->parents[j].row4.data[1] == levelTransforms[t].row4.data[1] &&
-						i->parents[j].row4.data[2] == levelTransforms[t].row4.data[2]) {
-						blenderObjects[counter].parentTransformIndex = t;
-						break;
-					}
+		// size everything once then let each model copy into its own slice
+		levelVertices.resize(vertexTotal);
+		levelIndices.resize(indexTotal);
+		levelMaterials.resize(materialTotal);
+		levelBatches.resize(batchTotal);
+		levelMeshes.resize(meshTotal);
+		ParallelFor(static_cast<unsigned>(levelModels.size()), [&](unsigned m) {
+			const LEVEL_MODEL& model = levelModels[m];
+			const H2B::MappedParser& p = parsers[modelSources[m]];
+			std::copy(p.vertices.begin(), p.vertices.end(), levelVertices.begin() + model.vertexStart);
+			std::copy(p.indices.begin(), p.indices.end(), levelIndices.begin() + model.indexStart);
+			std::copy(p.batches.begin(), p.batches.end(), levelBatches.begin() + model.batchStart);
+		});
+		// transfer all string data (mapped strings die with the parsers, level_strings is not thread safe)
+		for (unsigned m = 0; m < levelModels.size(); ++m) {
+			const LEVEL_MODEL& model = levelModels[m];
+			const H2B::MappedParser& p = parsers[modelSources[m]];
+			for (unsigned j = 0; j < p.materialCount; ++j) {
+				H2B::MATERIAL& material = levelMaterials[model.materialStart + j];
+				material = p.GetMaterial(j);
+				for (int k = 0; k < 10; ++k) {
+					if (*((&material.name) + k) != nullptr)
+						*((&material.name) + k) = level_strings.Intern(*((&material.name) + k));
 				}
-				counter++;
 			}
+			for (unsigned j = 0; j < p.meshCount; ++j) {
+				H2B::MESH& mesh = levelMeshes[model.meshStart + j];
+				mesh = p.GetMesh(j);
+				if (mesh.name != nullptr)
+					mesh.name = level_strings.Intern(mesh.name);
+			}
+		}
+		ResolveHierarchy(objectTransforms, objectParents);
+		log.LogCategorized("MESSAGE", "Importing of .H2B File Data Complete.");
+		return true;
+	}
+	// adds the collider, instance set and blender objects of the model that was just added to levelModels
+	void AddModelInstances(const MODEL_ENTRY& entry,
+		std::vector<int>& objectTransforms, std::vector<int>& objectParents) {
+		// *NEW* add overall collision volume(OBB) for this model, sized by ComputeLevelBounds
+		levelModels.back().colliderIndex = levelColliders.size();
+		levelColliders.push_back(GW::MATH::GOBBF{});
+		// add level model instances
+		MODEL_INSTANCES instances;
+		instances.flags = 0; // shadows? transparency? much we could do with this.
+		instances.modelIndex = levelModels.size() - 1;
+		instances.transformStart = levelTransforms.size();
+		instances.transformCount = entry.instances.size();
+		levelTransforms.insert(levelTransforms.end(), entry.instances.begin(), entry.instances.end());
+		// add instance set
+		levelInstances.push_back(instances);
+
+		// *NEW* Add an entry for each unique blender object
+		int offset = 0;
+		for (int j = 0; j < entry.blenderNames.size(); j++)
+		{
+			BLENDER_OBJECT obj{
+				entry.blenderNames[j],
+				instances.modelIndex, instances.transformStart + offset++
+			};
+			blenderObjects.push_back(obj);
+			objectTransforms[entry.objectIds[j]] = static_cast<int>(obj.transformIndex);
+			objectParents.push_back(entry.parents[j]);
 		}
+	}
+	// links every blender object to its parent's transform, objectTransforms is indexed by objectId
+	void ResolveHierarchy(const std::vector<int>& objectTransforms, const std::vector<int>& objectParents) {
+		// parents that failed to load leave their children at -1
+		ReportProgress(LOAD_RESOLVING_HIERARCHY, 0, static_cast<unsigned>(blenderObjects.size()));
+		for (unsigned o = 0; o < blenderObjects.size(); ++o)
+			blenderObjects[o].parentTransformIndex =
+				(objectParents[o] < 0) ? -1 : objectTransforms[objectParents[o]];
+		ReportProgress(LOAD_RESOLVING_HIERARCHY, static_cast<unsigned>(blenderObjects.size()),
+			static_cast<unsigned>(blenderObjects.size()));
+	}
+	// 64 bit hash of a whole file, 8 bytes at a time (only used to notice changed files, not cryptographic)
+	static unsigned long long HashContent(const unsigned char* data, size_t size, unsigned long long seed) {
+		unsigned long long hash = seed ^ (size * 0x9E3779B97F4A7C15ull);
+		size_t i = 0;
+		for (; i + 8 <= size; i += 8) {
+			unsigned long long word;
+			std::memcpy(&word, data + i, 8);
+			hash ^= word * 0xFF51AFD7ED558CCDull;
+			hash = ((hash << 31) | (hash >> 33)) * 0xC4CEB9FE1A85EC53ull;
+		}
+		unsigned long long tail = 0;
+		if (size > i)
+			std::memcpy(&tail, data + i, size - i);
+		hash ^= tail * 0xFF51AFD7ED558CCDull;
+		hash ^= hash >> 33;
+		hash *= 0xC4CEB9FE1A85EC53ull;
+		return hash ^ (hash >> 33);
+	}
+	// Same result as ReadAndCombineH2Bs followed by the per model import steps. Models whose .h2b
+	// contents and import settings match their cache in modelCacheFolder skip parsing and processing,
+	// the rest are imported together as usual and written back to the cache.
+	bool ReadCachedH2Bs(const char* h2bFolderPath,
+		const std::set<MODEL_ENTRY>& modelSet,
+		GW::SYSTEM::GLog log) {
+		log.LogCategorized("MESSAGE", "Begin Importing .H2B File Data (model cache).");
+		const std::string modelPath = h2bFolderPath;
+		const unsigned modelOptions = importOptions & ~LEVEL_WIDE_OPTIONS;
+		std::error_code error;
+		std::filesystem::create_directories(modelCacheFolder, error); // without it every model is a miss
+		std::vector<const MODEL_ENTRY*> entries;
+		entries.reserve(modelSet.size());
+		for (auto i = modelSet.begin(); i != modelSet.end(); ++i)
+			entries.push_back(&(*i));
+		auto cachePath = [&](unsigned e) { return modelCacheFolder + "/" + entries[e]->modelFile + ".cache"; };
+		// hash every source and try its cache, a cache is only used when everything it was built from matches
+		std::vector<unsigned long long> hashes(entries.size(), 0);
+		std::vector<Level_Data> cached(entries.size());
+		std::vector<char> hits(entries.size(), 0); // std::vector<bool> is not thread safe
+		ReportProgress(LOAD_IMPORTING_MODELS, 0, static_cast<unsigned>(entries.size()));
+		ParallelFor(static_cast<unsigned>(entries.size()), [&](unsigned e) {
+			if (LoadCanceled())
+				return;
+			MappedFile source;
+			if (source.Open((modelPath + "/" + entries[e]->modelFile).c_str())) {
+				hashes[e] = HashContent(source.Data(), source.Size(), MODEL_CACHE_VERSION);
+				Level_Data& model = cached[e];
+				hits[e] = model.LoadLevelPackage(cachePath(e).c_str(), GW::SYSTEM::GLog()) &&
+					model.levelModels.size() == 1 && model.packageSourceHash == hashes[e] &&
+					model.importOptions == modelOptions &&
+					((modelOptions & IMPORT_WELD_VERTICES) == 0 || model.weldEpsilon == weldEpsilon) &&
+					((modelOptions & IMPORT_LODS) == 0 || model.lodRatio == lodRatio);
+				if (hits[e] == 0)
+					model.UnloadLevel();
+			}
+			ReportStepDone();
+		});
+		if (LoadCanceled())
+			return false;
+		std::vector<const Level_Data*> sources(entries.size(), nullptr);
+		for (unsigned e = 0; e < entries.size(); ++e)
+			sources[e] = hits[e] ? &cached[e] : nullptr;
+		unsigned hitCount = 0, cacheFailures = 0;
+		for (char hit : hits)
+			hitCount += hit;
+		if (CombineModels(h2bFolderPath, entries, sources, std::vector<unsigned>(entries.size(), 0),
+			hashes, cacheFailures, log) == false)
+			return false;
+		log.LogCategorized("INFO", (std::string("Model Cache: ") + std::to_string(hitCount) + " hits, " +
+			std::to_string(entries.size() - hitCount) + " misses").c_str());
+		if (cacheFailures > 0)
+			log.LogCategorized("WARNING", (std::string("Model Cache: unable to write ") +
+				std::to_string(cacheFailures) + " model(s) to " + modelCacheFolder).c_str());
 		log.LogCategorized("MESSAGE", "Importing of .H2B File Data Complete.");
 		return true;
 	}
-};
\ No newline at end of file
+	// ReloadLevel's fast path. Succeeds only when the new level has exactly the loaded objects, each on the
+	// same unchanged model with the same parent, then copies over the matrices that differ.
+	bool PatchTransforms(const std::set<MODEL_ENTRY>& models,
+		const std::vector<std::string>& changedModelFiles,
+		std::vector<unsigned>& outMoved) {
+		std::unordered_map<std::string_view, unsigned> loadedObjects; // blender name -> blenderObjects index
+		loadedObjects.reserve(blenderObjects.size());
+		for (unsigned o = 0; o < blenderObjects.size(); ++o)
+			loadedObjects.emplace(blenderObjects[o].blendername, o);
+		std::vector<int> transformOwners(levelTransforms.size(), -1); // transform -> blenderObjects index
+		for (unsigned o = 0; o < blenderObjects.size(); ++o)
+			transformOwners[blenderObjects[o].transformIndex] = static_cast<int>(o);
+		unsigned objectCount = 0;
+		for (const MODEL_ENTRY& entry : models)
+			objectCount += static_cast<unsigned>(entry.objectIds.size());
+		if (objectCount != blenderObjects.size() || loadedObjects.size() != blenderObjects.size())
+			return false;
+		std::vector<const char*> objectNames(objectCount, nullptr); // objectId -> blender name
+		for (const MODEL_ENTRY& entry : models)
+			for (size_t j = 0; j < entry.objectIds.size(); ++j)
+				objectNames[entry.objectIds[j]] = entry.blenderNames[j];
+		auto sameName = [](const char* a, const char* b) {
+			return (a == nullptr || b == nullptr) ? a == b : std::strcmp(a, b) == 0;
+		};
+		std::vector<char> matched(blenderObjects.size(), 0);
+		std::vector<std::pair<unsigned, const GW::MATH::GMATRIXF*>> matrices; // applied once all objects match
+		matrices.reserve(objectCount);
+		for (const MODEL_ENTRY& entry : models) {
+			if (std::find(changedModelFiles.begin(), changedModelFiles.end(), entry.modelFile) !=
+				changedModelFiles.end())
+				return false;
+			for (size_t j = 0; j < entry.blenderNames.size(); ++j) {
+				auto loaded = loadedObjects.find(entry.blenderNames[j]);
+				if (loaded == loadedObjects.end() || matched[loaded->second])
+					return false;
+				const BLENDER_OBJECT& object = blenderObjects[loaded->second];
+				const char* loadedParent = (object.parentTransformIndex < 0 ||
+					transformOwners[object.parentTransformIndex] < 0) ? nullptr :
+					blenderObjects[transformOwners[object.parentTransformIndex]].blendername;
+				const char* parent = (entry.parents[j] < 0) ? nullptr : objectNames[entry.parents[j]];
+				if (entry.modelFile != levelModels[object.modelIndex].filename || sameName(parent, loadedParent) == false)
+					return false;
+				matched[loaded->second] = 1;
+				matrices.push_back({ object.transformIndex, &entry.instances[j] });
+			}
+		}
+		// merged objects are baked into their bucket, moving one means merging again
+		std::vector<char> merged(levelTransforms.size(), 0);
+		for (const MODEL_INSTANCES& instances : levelInstances)
+			if (instances.flags & INSTANCES_MERGED)
+				std::fill_n(merged.begin() + instances.transformStart, instances.transformCount, 1);
+		for (const auto& matrix : matrices)
+			if (merged[matrix.first] &&
+				std::memcmp(&levelTransforms[matrix.first], matrix.second, sizeof(GW::MATH::GMATRIXF)) != 0)
+				return false;
+		for (const auto& matrix : matrices)
+			if (std::memcmp(&levelTransforms[matrix.first], matrix.second, sizeof(GW::MATH::GMATRIXF)) != 0) {
+				levelTransforms[matrix.first] = *matrix.second;
+				outMoved.push_back(matrix.first);
+			}
+		std::sort(outMoved.begin(), outMoved.end());
+		return true;
+	}
+	// Builds the level from already processed models where sources[e] has one (model sourceModels[e])
+	// and imports & processes the rest, combined in entry order like ReadAndCombineH2Bs.
+	// Imported models are written to modelCacheFolder when cacheHashes has their source hashes.
+	bool CombineModels(const char* h2bFolderPath,
+		const std::vector<const MODEL_ENTRY*>& entries,
+		const std::vector<const Level_Data*>& sources,
+		const std::vector<unsigned>& sourceModels,
+		const std::vector<unsigned long long>& cacheHashes,
+		unsigned& outCacheFailures,
+		GW::SYSTEM::GLog log) {
+		const unsigned modelOptions = importOptions & ~LEVEL_WIDE_OPTIONS;
+		std::set<MODEL_ENTRY> missing;
+		std::unordered_map<std::string, unsigned> entryIndex;
+		for (unsigned e = 0; e < entries.size(); ++e)
+			if (sources[e] == nullptr) {
+				MODEL_ENTRY model = *entries[e]; // instances are added when combining, not here
+				model.blenderNames.clear();
+				model.instances.clear();
+				model.objectIds.clear();
+				model.parents.clear();
+				missing.insert(std::move(model));
+				entryIndex.emplace(entries[e]->modelFile, e);
+			}
+		Level_Data fresh;
+		std::vector<int> freshModel(entries.size(), -1); // which fresh model each entry became
+		if (missing.empty() == false) {
+			fresh.weldEpsilon = weldEpsilon;
+			fresh.lodRatio = lodRatio;
+			fresh.importOptions = modelOptions;
+			fresh.loadStatus = loadStatus; // shares progress & cancel with this load
+			if (fresh.ReadAndCombineH2Bs(h2bFolderPath, missing, log) == false ||
+				fresh.RunImportSteps(modelOptions, log) == false)
+				return false;
+			std::vector<char> saved(fresh.levelModels.size(), 1);
+			ParallelFor(static_cast<unsigned>(fresh.levelModels.size()), [&](unsigned m) {
+				const unsigned e = entryIndex.at(fresh.levelModels[m].filename);
+				freshModel[e] = static_cast<int>(m);
+				if (cacheHashes.empty())
+					return;
+				Level_Data model;
+				model.AppendModel(fresh, m);
+				model.importOptions = modelOptions;
+				model.weldEpsilon = weldEpsilon;
+				model.lodRatio = lodRatio;
+				model.packageSourceHash = cacheHashes[e];
+				saved[m] = model.SaveLevelPackage(
+					(modelCacheFolder + "/" + entries[e]->modelFile + ".cache").c_str(), GW::SYSTEM::GLog());
+			});
+			for (char s : saved)
+				outCacheFailures += (s == 0) ? 1 : 0;
+		}
+		// combine in level order exactly like ReadAndCombineH2Bs would have
+		unsigned objectCount = 0;
+		for (const MODEL_ENTRY* i : entries)
+			objectCount += static_cast<unsigned>(i->objectIds.size());
+		std::vector<int> objectTransforms(objectCount, -1); // objectId -> transform index
+		std::vector<int> objectParents; // parent objectId of each entry in blenderObjects
+		objectParents.reserve(objectCount);
+		for (unsigned e = 0; e < entries.size(); ++e) {
+			if (sources[e] != nullptr)
+				AppendModel(*sources[e], sourceModels[e]);
+			else if (freshModel[e] >= 0)
+				AppendModel(fresh, static_cast<unsigned>(freshModel[e]));
+			else
+				continue; // missing file, already reported by the import
+			AddModelInstances(*entries[e], objectTransforms, objectParents);
+		}
+		ResolveHierarchy(objectTransforms, objectParents);
+		return true;
+	}
+};
+#endif
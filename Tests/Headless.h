@@ -0,0 +1,10 @@
+// Precompiled header of the headless tests & benchmarks, the Source/Utils headers expect Gateware included first.
+// Only the libraries that build without a window or GPU are enabled.
+#define GATEWARE_ENABLE_CORE // All libraries need this
+#define GATEWARE_ENABLE_SYSTEM // GLog, GFile & GConcurrent
+#define GATEWARE_ENABLE_MATH // Enables all 3D Math Libraries
+#define GATEWARE_ENABLE_MATH2D // Enables all 2D Math Libraries
+#include "../ThirdParty/gateware-main/Gateware.h"
+#include <cstdio>
+#include <string>
+#include <vector>
@@ -0,0 +1,145 @@
+#include "Test.h"
+#include "LevelCompare.h"
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+static std::vector<std::string> ReadLines(const std::string& path)
+{
+	std::vector<std::string> lines;
+	std::ifstream file(path);
+	for (std::string line; std::getline(file, line);)
+		lines.push_back(line);
+	return lines;
+}
+
+static std::string WriteLevel(const std::string& name, const std::vector<std::string>& lines)
+{
+	std::error_code error;
+	const fs::path folder = fs::temp_directory_path() / "Wing3D_HotReloadTests";
+	fs::create_directories(folder, error);
+	const std::string path = (folder / name).string();
+	std::ofstream file(path, std::ios_base::trunc);
+	for (const std::string& line : lines)
+		file << line << '\n';
+	return path;
+}
+
+// line of object's MESH header, objects are "MESH", their name and four matrix rows
+static size_t FindObject(const std::vector<std::string>& lines, const char* object)
+{
+	for (size_t i = 0; i + 5 < lines.size(); ++i)
+		if (lines[i] == "MESH" && lines[i + 1] == object)
+			return i;
+	return lines.size();
+}
+
+// GameLevel with one number of object's translation row replaced
+static std::string MovedLevel(const char* name, const char* object, const char* from, const char* to)
+{
+	std::vector<std::string> lines = ReadLines(AssetPath("GameLevel.txt"));
+	const size_t header = FindObject(lines, object);
+	CHECK(header < lines.size() && lines[header + 5].find(from) != std::string::npos);
+	if (header < lines.size() && lines[header + 5].find(from) != std::string::npos)
+		lines[header + 5].replace(lines[header + 5].find(from), std::strlen(from), to);
+	return WriteLevel(name, lines);
+}
+
+// GameLevel without object
+static std::string RemovedLevel(const char* name, const char* object)
+{
+	std::vector<std::string> lines = ReadLines(AssetPath("GameLevel.txt"));
+	const size_t header = FindObject(lines, object);
+	CHECK(header < lines.size());
+	if (header < lines.size())
+		lines.erase(lines.begin() + header, lines.begin() + header + 6);
+	return WriteLevel(name, lines);
+}
+
+static int TransformOf(const Level_Data& level, const char* object)
+{
+	for (const Level_Data::BLENDER_OBJECT& blender : level.blenderObjects)
+		if (std::strcmp(blender.blendername, object) == 0)
+			return static_cast<int>(blender.transformIndex);
+	return -1;
+}
+
+static const unsigned reloadOptions = Level_Data::IMPORT_OPTIMIZE_MESHES | Level_Data::IMPORT_16BIT_INDICES;
+
+TEST(HotReload, MovedObjectPatchesTransform)
+{
+	const std::string original = AssetPath("GameLevel.txt"), models = AssetPath("Models");
+	const std::string moved = MovedLevel("moved.txt", "Barn", "1.1135", "3.1135");
+	Level_Data level, reference;
+	CHECK(level.LoadLevel(original.c_str(), models.c_str(), GW::SYSTEM::GLog(), reloadOptions));
+	CHECK(reference.LoadLevel(moved.c_str(), models.c_str(), GW::SYSTEM::GLog(), reloadOptions));
+	const int barn = TransformOf(level, "Barn");
+	CHECK(barn >= 0);
+	const H2B::VERTEX* vertices = level.levelVertices.data(); // a patch must not reallocate anything
+	Level_Data::LEVEL_CHANGES changes;
+	CHECK(level.ReloadLevel(original.c_str(), models.c_str(), GW::SYSTEM::GLog(), changes));
+	CHECK(changes.rebuilt == false && changes.movedTransforms.empty());
+	CHECK(level.ReloadLevel(moved.c_str(), models.c_str(), GW::SYSTEM::GLog(), changes));
+	CHECK(changes.rebuilt == false);
+	CHECK(changes.movedTransforms == std::vector<unsigned>(1, static_cast<unsigned>(barn)));
+	CHECK(level.levelVertices.data() == vertices);
+	CHECK(SameLevel(level, reference));
+}
+
+TEST(HotReload, AddedAndRemovedObjectsRebuild)
+{
+	const std::string original = AssetPath("GameLevel.txt"), models = AssetPath("Models");
+	const std::string removed = RemovedLevel("removed.txt", "Pug");
+	Level_Data level, reference, smaller;
+	CHECK(level.LoadLevel(original.c_str(), models.c_str(), GW::SYSTEM::GLog(), reloadOptions));
+	CHECK(reference.LoadLevel(original.c_str(), models.c_str(), GW::SYSTEM::GLog(), reloadOptions));
+	CHECK(smaller.LoadLevel(removed.c_str(), models.c_str(), GW::SYSTEM::GLog(), reloadOptions));
+	const unsigned modelCount = static_cast<unsigned>(reference.levelModels.size());
+	CHECK(smaller.levelModels.size() + 1 == modelCount); // Pug is the only object using its model
+	// everything left is already loaded
+	Level_Data::LEVEL_CHANGES changes;
+	CHECK(level.ReloadLevel(removed.c_str(), models.c_str(), GW::SYSTEM::GLog(), changes));
+	CHECK(changes.rebuilt && changes.movedTransforms.empty());
+	CHECK(changes.importedModels == 0 && changes.reusedModels == modelCount - 1);
+	CHECK(SameLevel(level, smaller));
+	// bringing it back imports just that model
+	CHECK(level.ReloadLevel(original.c_str(), models.c_str(), GW::SYSTEM::GLog(), changes));
+	CHECK(changes.rebuilt && changes.importedModels == 1 && changes.reusedModels == modelCount - 1);
+	CHECK(SameLevel(level, reference));
+	// an edited model file is imported again even when no object moved
+	CHECK(level.ReloadLevel(original.c_str(), models.c_str(), GW::SYSTEM::GLog(), changes, { "BigBarn.h2b" }));
+	CHECK(changes.rebuilt && changes.importedModels == 1 && changes.reusedModels == modelCount - 1);
+	CHECK(SameLevel(level, reference));
+}
+
+TEST(HotReload, MergedObjectRebuilds)
+{
+	const std::string original = AssetPath("GameLevel.txt"), models = AssetPath("Models");
+	const std::string moved = MovedLevel("merged.txt", "Pug", "-5.0907", "-4.0907");
+	Level_Data level, reference;
+	const unsigned options = reloadOptions | Level_Data::IMPORT_MERGE_STATIC;
+	CHECK(level.LoadLevel(original.c_str(), models.c_str(), GW::SYSTEM::GLog(), options));
+	CHECK(reference.LoadLevel(moved.c_str(), models.c_str(), GW::SYSTEM::GLog(), options));
+	CHECK(level.levelMergedBuckets.empty() == false);
+	// Pug is placed once so it is baked into a bucket, its new matrix has to be merged again
+	Level_Data::LEVEL_CHANGES changes;
+	CHECK(level.ReloadLevel(moved.c_str(), models.c_str(), GW::SYSTEM::GLog(), changes));
+	CHECK(changes.rebuilt && changes.importedModels == 0);
+	CHECK(SameLevel(level, reference));
+	CHECK(level.levelMergedVertices.size() == reference.levelMergedVertices.size() &&
+		std::memcmp(level.levelMergedVertices.data(), reference.levelMergedVertices.data(),
+			sizeof(H2B::VERTEX) * level.levelMergedVertices.size()) == 0);
+}
+
+TEST(HotReload, UnreadableLevelKeepsLoadedLevel)
+{
+	const std::string original = AssetPath("GameLevel.txt"), models = AssetPath("Models");
+	Level_Data level, reference;
+	CHECK(level.LoadLevel(original.c_str(), models.c_str(), GW::SYSTEM::GLog(), reloadOptions));
+	CHECK(reference.LoadLevel(original.c_str(), models.c_str(), GW::SYSTEM::GLog(), reloadOptions));
+	Level_Data::LEVEL_CHANGES changes;
+	CHECK(level.ReloadLevel(AssetPath("Missing.txt").c_str(), models.c_str(), GW::SYSTEM::GLog(), changes) == false);
+	CHECK(SameLevel(level, reference));
+	std::error_code error;
+	fs::remove_all(fs::temp_directory_path() / "Wing3D_HotReloadTests", error);
+}
@@ -0,0 +1,59 @@
+#include "Test.h"
+#include "../Source/Utils/lvlData.h"
+
+TEST(IndexPacking, PicksNarrowestFormat)
+{
+	std::vector<unsigned short> indices16;
+	std::vector<unsigned> indices32;
+	const unsigned small[] = { 0, 1, 2, 2, 1, 3 };
+	const unsigned largest16[] = { 65535, 0, 1 }; // the top of the 16 bit range still fits
+	const unsigned first32[] = { 65536, 0, 1 };
+	const unsigned large[] = { 7, 100000, 8 };
+	H2B::PACKED_INDICES a = H2B::PackIndices(small, 6, indices16, indices32);
+	H2B::PACKED_INDICES b = H2B::PackIndices(largest16, 3, indices16, indices32);
+	H2B::PACKED_INDICES c = H2B::PackIndices(first32, 3, indices16, indices32);
+	H2B::PACKED_INDICES d = H2B::PackIndices(large, 3, indices16, indices32);
+	H2B::PACKED_INDICES e = H2B::PackIndices(nullptr, 0, indices16, indices32);
+	CHECK(a.wide == 0 && a.start == 0);
+	CHECK(b.wide == 0 && b.start == 6);
+	CHECK(c.wide == 1 && c.start == 0);
+	CHECK(d.wide == 1 && d.start == 3);
+	CHECK(e.wide == 0 && e.start == 9);
+	CHECK(indices16.size() == 9 && indices32.size() == 6);
+	// values come back unchanged from either array
+	CHECK(std::equal(small, small + 6, indices16.begin()));
+	CHECK(std::equal(largest16, largest16 + 3, indices16.begin() + 6));
+	CHECK(std::equal(first32, first32 + 3, indices32.begin()));
+	CHECK(std::equal(large, large + 3, indices32.begin() + 3));
+}
+
+TEST(IndexPacking, GameLevelRoundTrip)
+{
+	Level_Data level;
+	CHECK(level.LoadLevel(AssetPath("GameLevel.txt").c_str(), AssetPath("Models").c_str(), GW::SYSTEM::GLog(),
+		Level_Data::IMPORT_16BIT_INDICES));
+	CHECK(level.levelPackedIndices.size() == level.levelModels.size());
+	CHECK(level.levelIndices16.size() + level.levelIndices32.size() == level.levelIndices.size());
+	if (level.levelPackedIndices.size() != level.levelModels.size())
+		return;
+	unsigned wrongFormat = 0, wrongValues = 0, narrow = 0;
+	for (unsigned m = 0; m < level.levelModels.size(); ++m) {
+		const Level_Data::LEVEL_MODEL& model = level.levelModels[m];
+		const H2B::PACKED_INDICES& packed = level.levelPackedIndices[m];
+		const unsigned* indices = level.levelIndices.data() + model.indexStart;
+		const unsigned largest = model.indexCount ? *std::max_element(indices, indices + model.indexCount) : 0;
+		wrongFormat += packed.wide != (largest > 0xFFFF ? 1u : 0u);
+		narrow += packed.wide == 0;
+		const size_t available = packed.wide ? level.levelIndices32.size() : level.levelIndices16.size();
+		if (packed.start + model.indexCount > available) {
+			++wrongValues;
+			continue;
+		}
+		for (unsigned i = 0; i < model.indexCount; ++i)
+			wrongValues += (packed.wide ? level.levelIndices32[packed.start + i] :
+				level.levelIndices16[packed.start + i]) != indices[i];
+	}
+	CHECK(wrongFormat == 0);
+	CHECK(wrongValues == 0);
+	CHECK(narrow > 0);
+}
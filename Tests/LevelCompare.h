@@ -0,0 +1,31 @@
+#ifndef _LEVELCOMPARE_H_
+#define _LEVELCOMPARE_H_
+#include "../Source/Utils/lvlData.h"
+
+// true when two loads produced the same level data, used to compare the shortcuts with a plain LoadLevel
+inline bool SameLevel(const Level_Data& a, const Level_Data& b)
+{
+	bool same = a.levelVertices.size() == b.levelVertices.size() && a.levelIndices == b.levelIndices &&
+		std::memcmp(a.levelVertices.data(), b.levelVertices.data(), sizeof(H2B::VERTEX) * a.levelVertices.size()) == 0 &&
+		a.levelModels.size() == b.levelModels.size() && a.levelMeshes.size() == b.levelMeshes.size() &&
+		a.levelMaterials.size() == b.levelMaterials.size() && a.blenderObjects.size() == b.blenderObjects.size() &&
+		a.levelTransforms.size() == b.levelTransforms.size() && a.levelMeshLods.size() == b.levelMeshLods.size() &&
+		std::memcmp(a.levelMeshLods.data(), b.levelMeshLods.data(), sizeof(Level_Data::MESH_LOD) * a.levelMeshLods.size()) == 0 &&
+		std::memcmp(a.levelTransforms.data(), b.levelTransforms.data(), sizeof(GW::MATH::GMATRIXF) * a.levelTransforms.size()) == 0;
+	for (size_t m = 0; same && m < a.levelModels.size(); ++m) {
+		const Level_Data::LEVEL_MODEL& x = a.levelModels[m];
+		const Level_Data::LEVEL_MODEL& y = b.levelModels[m];
+		same = std::strcmp(x.filename, y.filename) == 0 && x.vertexStart == y.vertexStart &&
+			x.indexStart == y.indexStart && x.indexCount == y.indexCount && x.meshStart == y.meshStart;
+	}
+	for (size_t m = 0; same && m < a.levelMeshes.size(); ++m)
+		same = std::strcmp(a.levelMeshes[m].name, b.levelMeshes[m].name) == 0 &&
+			a.levelMeshes[m].drawInfo.indexCount == b.levelMeshes[m].drawInfo.indexCount &&
+			a.levelMeshes[m].drawInfo.indexOffset == b.levelMeshes[m].drawInfo.indexOffset;
+	for (size_t o = 0; same && o < a.blenderObjects.size(); ++o)
+		same = std::strcmp(a.blenderObjects[o].blendername, b.blenderObjects[o].blendername) == 0 &&
+			a.blenderObjects[o].transformIndex == b.blenderObjects[o].transformIndex &&
+			a.blenderObjects[o].parentTransformIndex == b.blenderObjects[o].parentTransformIndex;
+	return same;
+}
+#endif
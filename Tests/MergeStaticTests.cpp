@@ -0,0 +1,77 @@
+#include "Test.h"
+#include "../Source/Utils/lvlData.h"
+
+// GameLevel with every model placed up to four times merged, like the shipped mergeInstanceLimit
+static bool LoadMerged(Level_Data& level)
+{
+	level.mergeInstanceLimit = 4;
+	return level.LoadLevel(AssetPath("GameLevel.txt").c_str(), AssetPath("Models").c_str(), GW::SYSTEM::GLog(),
+		Level_Data::IMPORT_MERGE_STATIC);
+}
+
+TEST(MergeStatic, ChildrenStayInstanced)
+{
+	Level_Data level;
+	CHECK(LoadMerged(level));
+	std::vector<char> children(level.levelTransforms.size(), 0);
+	unsigned childCount = 0;
+	for (const Level_Data::BLENDER_OBJECT& object : level.blenderObjects)
+		if (object.parentTransformIndex >= 0) {
+			children[object.transformIndex] = 1;
+			++childCount;
+		}
+	CHECK(childCount > 0); // Cow.001, Llama.001 and Sheep.001
+	unsigned merged = 0, mergedChildren = 0;
+	for (const Level_Data::MODEL_INSTANCES& instances : level.levelInstances) {
+		if ((instances.flags & Level_Data::INSTANCES_MERGED) == 0)
+			continue;
+		++merged;
+		for (unsigned t = instances.transformStart; t < instances.transformStart + instances.transformCount; ++t)
+			mergedChildren += children[t];
+	}
+	CHECK(merged > 0);
+	CHECK(mergedChildren == 0);
+}
+
+TEST(MergeStatic, BakedIntoWorldSpace)
+{
+	Level_Data level;
+	CHECK(LoadMerged(level));
+	// every vertex a merged mesh uses, moved by its object's matrix
+	double expected[3] = {}, baked[3] = {};
+	size_t expectedCount = 0;
+	for (const Level_Data::MODEL_INSTANCES& instances : level.levelInstances) {
+		if ((instances.flags & Level_Data::INSTANCES_MERGED) == 0)
+			continue;
+		const Level_Data::LEVEL_MODEL& model = level.levelModels[instances.modelIndex];
+		for (unsigned t = instances.transformStart; t < instances.transformStart + instances.transformCount; ++t) {
+			const GW::MATH::GMATRIXF& m = level.levelTransforms[t];
+			for (unsigned i = model.meshStart; i < model.meshStart + model.meshCount; ++i) {
+				const H2B::BATCH& drawInfo = level.levelMeshes[i].drawInfo;
+				const unsigned* indices = level.levelIndices.data() + model.indexStart + drawInfo.indexOffset;
+				std::vector<unsigned> used(indices, indices + drawInfo.indexCount);
+				std::sort(used.begin(), used.end());
+				used.erase(std::unique(used.begin(), used.end()), used.end());
+				for (unsigned v : used) {
+					const H2B::VECTOR& p = level.levelVertices[model.vertexStart + v].pos;
+					expected[0] += p.x * m.row1.x + p.y * m.row2.x + p.z * m.row3.x + m.row4.x;
+					expected[1] += p.x * m.row1.y + p.y * m.row2.y + p.z * m.row3.y + m.row4.y;
+					expected[2] += p.x * m.row1.z + p.y * m.row2.z + p.z * m.row3.z + m.row4.z;
+				}
+				expectedCount += used.size();
+			}
+		}
+	}
+	for (const H2B::VERTEX& vertex : level.levelMergedVertices) {
+		baked[0] += vertex.pos.x;
+		baked[1] += vertex.pos.y;
+		baked[2] += vertex.pos.z;
+	}
+	CHECK(expectedCount > 0 && expectedCount == level.levelMergedVertices.size());
+	for (int axis = 0; axis < 3; ++axis)
+		CHECK(std::fabs(expected[axis] - baked[axis]) <= 1e-3 * (1.0 + expectedCount));
+	// each bucket draws with the identity matrix added after the level's own transforms
+	for (const Level_Data::MERGED_BUCKET& bucket : level.levelMergedBuckets)
+		CHECK(std::memcmp(&level.levelTransforms[bucket.transformIndex], &GW::MATH::GIdentityMatrixF,
+			sizeof(GW::MATH::GMATRIXF)) == 0);
+}
@@ -0,0 +1,161 @@
+#include "Test.h"
+#include "../Source/Utils/lvlData.h"
+
+// A (size x size) quad grid bent into a hill by height, clockwise in a left handed space
+static void MakeHill(unsigned size, float height, std::vector<H2B::VERTEX>& vertices, std::vector<unsigned>& indices)
+{
+	vertices.clear();
+	indices.clear();
+	for (unsigned z = 0; z <= size; ++z)
+		for (unsigned x = 0; x <= size; ++x) {
+			float u = x / float(size) - 0.5f, v = z / float(size) - 0.5f;
+			H2B::VERTEX vertex = {};
+			vertex.pos = { float(x), height * std::cos(u * 3.0f) * std::cos(v * 3.0f), float(z) };
+			vertex.uvw = { u, v, 0 };
+			vertex.nrm = { 0, 1, 0 };
+			vertices.push_back(vertex);
+		}
+	for (unsigned z = 0; z < size; ++z)
+		for (unsigned x = 0; x < size; ++x) {
+			unsigned corner = z * (size + 1) + x;
+			unsigned quad[6] = { corner, corner + size + 1, corner + 1, corner + 1, corner + size + 1, corner + size + 2 };
+			indices.insert(indices.end(), quad, quad + 6);
+		}
+}
+
+// closest distance from p to triangle abc: inside the triangle it's the plane distance, otherwise the nearest edge
+static double PointTriangleDistance(const H2B::VECTOR& p, const H2B::VECTOR& a, const H2B::VECTOR& b, const H2B::VECTOR& c)
+{
+	auto segment = [&p](const H2B::VECTOR& s, const H2B::VECTOR& e) {
+		double d[3] = { e.x - s.x, e.y - s.y, e.z - s.z }, w[3] = { p.x - s.x, p.y - s.y, p.z - s.z };
+		double length = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+		double t = length > 0 ? std::fmin(1.0, std::fmax(0.0, (w[0] * d[0] + w[1] * d[1] + w[2] * d[2]) / length)) : 0.0;
+		double x = w[0] - d[0] * t, y = w[1] - d[1] * t, z = w[2] - d[2] * t;
+		return std::sqrt(x * x + y * y + z * z);
+	};
+	double best = std::fmin(segment(a, b), std::fmin(segment(b, c), segment(c, a)));
+	double ab[3] = { b.x - a.x, b.y - a.y, b.z - a.z }, ac[3] = { c.x - a.x, c.y - a.y, c.z - a.z };
+	double n[3] = { ab[1] * ac[2] - ab[2] * ac[1], ab[2] * ac[0] - ab[0] * ac[2], ab[0] * ac[1] - ab[1] * ac[0] };
+	double area = n[0] * n[0] + n[1] * n[1] + n[2] * n[2];
+	if (area == 0)
+		return best;
+	double ap[3] = { p.x - a.x, p.y - a.y, p.z - a.z };
+	double height = (ap[0] * n[0] + ap[1] * n[1] + ap[2] * n[2]) / area;
+	double q[3] = { ap[0] - n[0] * height, ap[1] - n[1] * height, ap[2] - n[2] * height }; // relative to a, in the plane
+	// barycentric weights of the projected point
+	double qb[3] = { ab[1] * q[2] - ab[2] * q[1], ab[2] * q[0] - ab[0] * q[2], ab[0] * q[1] - ab[1] * q[0] };
+	double qc[3] = { q[1] * ac[2] - q[2] * ac[1], q[2] * ac[0] - q[0] * ac[2], q[0] * ac[1] - q[1] * ac[0] };
+	double v = (qc[0] * n[0] + qc[1] * n[1] + qc[2] * n[2]) / area;
+	double w = (qb[0] * n[0] + qb[1] * n[1] + qb[2] * n[2]) / area;
+	if (v >= 0 && w >= 0 && v + w <= 1)
+		best = std::fmin(best, std::fabs(height) * std::sqrt(area));
+	return best;
+}
+
+// furthest any vertex of original gets from the surface of simplified, by testing every triangle
+static double BruteForceError(const unsigned* original, unsigned originalCount, const unsigned* simplified,
+	unsigned simplifiedCount, const H2B::VERTEX* vertices)
+{
+	std::vector<unsigned> used(original, original + originalCount);
+	std::sort(used.begin(), used.end());
+	used.erase(std::unique(used.begin(), used.end()), used.end());
+	double error = 0;
+	for (unsigned i : used) {
+		double nearest = DBL_MAX;
+		for (unsigned t = 0; t + 2 < simplifiedCount && nearest > 0; t += 3)
+			nearest = std::fmin(nearest, PointTriangleDistance(vertices[i].pos, vertices[simplified[t]].pos,
+				vertices[simplified[t + 1]].pos, vertices[simplified[t + 2]].pos));
+		error = std::fmax(error, nearest);
+	}
+	return error;
+}
+
+TEST(MeshSimplifier, ReachesTargetWithinBounds)
+{
+	std::vector<H2B::VERTEX> vertices;
+	std::vector<unsigned> original;
+	MakeHill(30, 4.0f, vertices, original);
+	const unsigned vertexCount = static_cast<unsigned>(vertices.size());
+	unsigned previous = static_cast<unsigned>(original.size());
+	for (unsigned target : { 3000u, 1500u, 600u, 150u }) {
+		std::vector<unsigned> simplified = original;
+		float error = H2B::SimplifyMesh(simplified, vertices.data(), vertexCount, target);
+		CHECK(simplified.size() % 3 == 0);
+		CHECK(simplified.size() <= target);
+		CHECK(simplified.size() < previous);
+		previous = static_cast<unsigned>(simplified.size());
+		unsigned outOfRange = 0;
+		for (unsigned i : simplified)
+			outOfRange += i >= vertexCount;
+		CHECK(outOfRange == 0);
+		double measured = BruteForceError(original.data(), static_cast<unsigned>(original.size()), simplified.data(),
+			static_cast<unsigned>(simplified.size()), vertices.data());
+		CHECK(error >= measured - 1e-4);
+	}
+}
+
+TEST(MeshSimplifier, FlatGridLosesNothing)
+{
+	std::vector<H2B::VERTEX> vertices;
+	std::vector<unsigned> indices;
+	MakeHill(20, 0.0f, vertices, indices);
+	float error = H2B::SimplifyMesh(indices, vertices.data(), static_cast<unsigned>(vertices.size()), 200);
+	CHECK(indices.size() <= 200);
+	CHECK(error < 1e-4f); // every vertex is still on the plane, borders are held in place
+}
+
+TEST(MeshSimplifier, LeavesBadInputAlone)
+{
+	std::vector<H2B::VERTEX> vertices;
+	std::vector<unsigned> indices;
+	MakeHill(4, 1.0f, vertices, indices);
+	indices[5] = static_cast<unsigned>(vertices.size());
+	std::vector<unsigned> before = indices;
+	CHECK(H2B::SimplifyMesh(indices, vertices.data(), static_cast<unsigned>(vertices.size()), 6) == 0);
+	CHECK(indices == before);
+}
+
+TEST(MeshSimplifier, GameLevelLods)
+{
+	Level_Data level;
+	CHECK(level.LoadLevel(AssetPath("GameLevel.txt").c_str(), AssetPath("Models").c_str(), GW::SYSTEM::GLog(),
+		Level_Data::IMPORT_LODS));
+	CHECK(level.levelMeshLods.size() == level.levelMeshes.size() * Level_Data::LOD_COUNT);
+	if (level.levelMeshLods.size() != level.levelMeshes.size() * Level_Data::LOD_COUNT)
+		return;
+	unsigned reduced = 0, measuredLods = 0;
+	for (const Level_Data::LEVEL_MODEL& model : level.levelModels) {
+		const unsigned* indices = level.levelIndices.data() + model.indexStart;
+		const H2B::VERTEX* vertices = level.levelVertices.data() + model.vertexStart;
+		for (unsigned i = 0; i < model.meshCount; ++i) {
+			const Level_Data::MESH_LOD* lods = &level.levelMeshLods[(model.meshStart + i) * Level_Data::LOD_COUNT];
+			const H2B::BATCH& drawInfo = level.levelMeshes[model.meshStart + i].drawInfo;
+			CHECK(lods[0].indexOffset == drawInfo.indexOffset && lods[0].indexCount == drawInfo.indexCount);
+			CHECK(lods[0].error == 0);
+			for (unsigned lod = 0; lod < Level_Data::LOD_COUNT; ++lod) {
+				CHECK(lods[lod].indexCount % 3 == 0);
+				CHECK(lods[lod].indexOffset + lods[lod].indexCount <= model.indexCount);
+				unsigned outOfRange = 0;
+				for (unsigned k = 0; k < lods[lod].indexCount; ++k)
+					outOfRange += indices[lods[lod].indexOffset + k] >= model.vertexCount;
+				CHECK(outOfRange == 0);
+				if (lod == 0)
+					continue;
+				// fewer triangles and more error every step, a LOD that couldn't shrink repeats the last one
+				CHECK(lods[lod].indexCount <= lods[lod - 1].indexCount);
+				CHECK(lods[lod].error >= lods[lod - 1].error);
+				reduced += lods[lod].indexCount < lods[lod - 1].indexCount;
+				// checking every vertex against every triangle gets slow, the big meshes are left to the grid tests
+				if (static_cast<unsigned long long>(drawInfo.indexCount) * lods[lod].indexCount > 100000000ull)
+					continue;
+				double measured = BruteForceError(indices + drawInfo.indexOffset, drawInfo.indexCount,
+					indices + lods[lod].indexOffset, lods[lod].indexCount, vertices);
+				CHECK(lods[lod].error >= measured - 1e-4 * (1 + measured));
+				++measuredLods;
+			}
+		}
+	}
+	CHECK(reduced > 0);
+	CHECK(measuredLods > 0);
+	std::printf("  %u LODs smaller than the one before, %u checked against brute force\n", reduced, measuredLods);
+}
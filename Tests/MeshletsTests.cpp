@@ -0,0 +1,162 @@
+#include "Test.h"
+#include "../Source/Utils/lvlData.h"
+
+// A wavy (size x size) quad grid, clockwise in a left handed space like the exported models
+static void MakeGrid(unsigned size, std::vector<H2B::VERTEX>& vertices, std::vector<unsigned>& indices)
+{
+	vertices.clear();
+	indices.clear();
+	for (unsigned z = 0; z <= size; ++z)
+		for (unsigned x = 0; x <= size; ++x) {
+			H2B::VERTEX v = {};
+			v.pos = { float(x), std::sin(x * 0.7f) * std::cos(z * 0.5f) * 2.0f, float(z) };
+			v.nrm = { 0, 1, 0 };
+			vertices.push_back(v);
+		}
+	for (unsigned z = 0; z < size; ++z)
+		for (unsigned x = 0; x < size; ++x) {
+			unsigned corner = z * (size + 1) + x;
+			unsigned quad[6] = { corner, corner + size + 1, corner + 1, corner + 1, corner + size + 1, corner + size + 2 };
+			indices.insert(indices.end(), quad, quad + 6);
+		}
+}
+
+// the meshlets of range must cover each of its whole triangles exactly once and stay within the limits
+static void CheckMeshlets(const unsigned* indices, H2B::BATCH range, const H2B::VERTEX* vertices,
+	const H2B::MESHLET* meshlets, unsigned meshletCount)
+{
+	const unsigned triangles = range.indexCount / 3;
+	std::vector<unsigned> covered(triangles, 0);
+	for (unsigned m = 0; m < meshletCount; ++m) {
+		const H2B::MESHLET& meshlet = meshlets[m];
+		CHECK(meshlet.indexCount > 0 && meshlet.indexCount % 3 == 0);
+		CHECK(meshlet.indexOffset >= range.indexOffset);
+		CHECK(meshlet.indexOffset + meshlet.indexCount <= range.indexOffset + triangles * 3);
+		if (meshlet.indexOffset < range.indexOffset || meshlet.indexOffset + meshlet.indexCount > range.indexOffset + triangles * 3)
+			continue;
+		for (unsigned t = 0; t < meshlet.indexCount / 3; ++t)
+			++covered[(meshlet.indexOffset - range.indexOffset) / 3 + t];
+		CHECK(meshlet.indexCount / 3 <= H2B::MESHLET_MAX_TRIANGLES);
+		std::vector<unsigned> unique(indices + meshlet.indexOffset, indices + meshlet.indexOffset + meshlet.indexCount);
+		std::sort(unique.begin(), unique.end());
+		unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+		CHECK(unique.size() <= H2B::MESHLET_MAX_VERTICES);
+		// every corner inside the bounding sphere, give or take float rounding
+		for (unsigned i : unique) {
+			const H2B::VECTOR& p = vertices[i].pos;
+			float x = p.x - meshlet.center.x, y = p.y - meshlet.center.y, z = p.z - meshlet.center.z;
+			CHECK(std::sqrt(x * x + y * y + z * z) <= meshlet.radius * 1.0001f + 1e-5f);
+		}
+	}
+	unsigned wrong = 0;
+	for (unsigned count : covered)
+		wrong += count != 1;
+	CHECK(wrong == 0);
+}
+
+TEST(Meshlets, PartitionGrid)
+{
+	std::vector<H2B::VERTEX> vertices;
+	std::vector<unsigned> indices;
+	MakeGrid(60, vertices, indices);
+	const unsigned vertexCount = static_cast<unsigned>(vertices.size());
+	const unsigned indexCount = static_cast<unsigned>(indices.size());
+	// the whole mesh, a range in the middle and one with a stray index past its last triangle
+	const H2B::BATCH ranges[] = { { indexCount, 0 }, { 3000, 1500 }, { 301, 600 } };
+	for (const H2B::BATCH& range : ranges) {
+		std::vector<H2B::MESHLET> meshlets;
+		unsigned count = H2B::BuildMeshlets(indices.data(), range, vertices.data(), vertexCount, meshlets);
+		CHECK(count == meshlets.size());
+		CHECK(count >= (range.indexCount / 3 + H2B::MESHLET_MAX_TRIANGLES - 1) / H2B::MESHLET_MAX_TRIANGLES);
+		CheckMeshlets(indices.data(), range, vertices.data(), meshlets.data(), count);
+	}
+}
+
+TEST(Meshlets, RejectsOutOfRangeIndices)
+{
+	std::vector<H2B::VERTEX> vertices;
+	std::vector<unsigned> indices;
+	MakeGrid(4, vertices, indices);
+	indices[7] = static_cast<unsigned>(vertices.size());
+	std::vector<H2B::MESHLET> meshlets;
+	CHECK(H2B::BuildMeshlets(indices.data(), { static_cast<unsigned>(indices.size()), 0 }, vertices.data(),
+		static_cast<unsigned>(vertices.size()), meshlets) == 0);
+	CHECK(meshlets.empty());
+}
+
+TEST(Meshlets, BackfacingConeIsConservative)
+{
+	std::vector<H2B::VERTEX> vertices;
+	std::vector<unsigned> indices;
+	MakeGrid(40, vertices, indices);
+	std::vector<H2B::MESHLET> meshlets;
+	H2B::BuildMeshlets(indices.data(), { static_cast<unsigned>(indices.size()), 0 }, vertices.data(),
+		static_cast<unsigned>(vertices.size()), meshlets);
+	unsigned culled = 0, wrong = 0;
+	for (int camera = 0; camera < 64; ++camera) {
+		// above and below the grid, near and far
+		float height = (camera % 2 ? 1.0f : -1.0f) * (3.0f + camera * 2.0f);
+		H2B::VECTOR eye = { float(camera % 8) * 6.0f, height, float(camera / 8) * 6.0f };
+		for (const H2B::MESHLET& meshlet : meshlets) {
+			if (H2B::IsMeshletBackfacing(meshlet, eye) == false)
+				continue;
+			++culled;
+			for (unsigned i = meshlet.indexOffset; i < meshlet.indexOffset + meshlet.indexCount; i += 3) {
+				const H2B::VECTOR& p0 = vertices[indices[i]].pos;
+				const H2B::VECTOR& p1 = vertices[indices[i + 1]].pos;
+				const H2B::VECTOR& p2 = vertices[indices[i + 2]].pos;
+				H2B::VECTOR e1 = { p1.x - p0.x, p1.y - p0.y, p1.z - p0.z };
+				H2B::VECTOR e2 = { p2.x - p0.x, p2.y - p0.y, p2.z - p0.z };
+				H2B::VECTOR n = { e1.y * e2.z - e1.z * e2.y, e1.z * e2.x - e1.x * e2.z, e1.x * e2.y - e1.y * e2.x };
+				// a back face's normal points away from the eye
+				wrong += n.x * (p0.x - eye.x) + n.y * (p0.y - eye.y) + n.z * (p0.z - eye.z) < 0;
+			}
+		}
+	}
+	CHECK(culled > 0);
+	CHECK(wrong == 0);
+}
+
+TEST(Meshlets, PartitionGameLevel)
+{
+	Level_Data level;
+	CHECK(level.LoadLevel(AssetPath("GameLevel.txt").c_str(), AssetPath("Models").c_str(), GW::SYSTEM::GLog(),
+		Level_Data::IMPORT_OPTIMIZE_MESHES | Level_Data::IMPORT_MESHLETS));
+	CHECK(level.levelMeshletRanges.size() == level.levelMeshes.size());
+	unsigned next = 0;
+	for (const Level_Data::LEVEL_MODEL& model : level.levelModels)
+		for (unsigned i = 0; i < model.meshCount; ++i) {
+			const Level_Data::MESHLET_RANGE& range = level.levelMeshletRanges[model.meshStart + i];
+			CHECK(range.meshletStart == next); // grouped by mesh in mesh order
+			next = range.meshletStart + range.meshletCount;
+			if (next > level.levelMeshlets.size())
+				return;
+			CheckMeshlets(level.levelIndices.data() + model.indexStart, level.levelMeshes[model.meshStart + i].drawInfo,
+				level.levelVertices.data() + model.vertexStart, level.levelMeshlets.data() + range.meshletStart,
+				range.meshletCount);
+		}
+	CHECK(next == level.levelMeshlets.size());
+}
+
+TEST(Meshlets, Deterministic)
+{
+	std::vector<H2B::VERTEX> vertices;
+	std::vector<unsigned> indices;
+	MakeGrid(50, vertices, indices);
+	std::vector<H2B::MESHLET> first, second;
+	H2B::BuildMeshlets(indices.data(), { static_cast<unsigned>(indices.size()), 0 }, vertices.data(),
+		static_cast<unsigned>(vertices.size()), first);
+	H2B::BuildMeshlets(indices.data(), { static_cast<unsigned>(indices.size()), 0 }, vertices.data(),
+		static_cast<unsigned>(vertices.size()), second);
+	CHECK(first.size() == second.size());
+	CHECK(std::memcmp(first.data(), second.data(), sizeof(H2B::MESHLET) * first.size()) == 0);
+	// models are split in parallel, the level's meshlets must not depend on which thread got there first
+	Level_Data a, b;
+	const unsigned options = Level_Data::IMPORT_OPTIMIZE_MESHES | Level_Data::IMPORT_MESHLETS;
+	CHECK(a.LoadLevel(AssetPath("GameLevel.txt").c_str(), AssetPath("Models").c_str(), GW::SYSTEM::GLog(), options));
+	CHECK(b.LoadLevel(AssetPath("GameLevel.txt").c_str(), AssetPath("Models").c_str(), GW::SYSTEM::GLog(), options));
+	CHECK(a.levelMeshlets.size() > 0 && a.levelMeshlets.size() == b.levelMeshlets.size());
+	CHECK(std::memcmp(a.levelMeshlets.data(), b.levelMeshlets.data(), sizeof(H2B::MESHLET) * a.levelMeshlets.size()) == 0);
+	CHECK(std::memcmp(a.levelMeshletRanges.data(), b.levelMeshletRanges.data(),
+		sizeof(Level_Data::MESHLET_RANGE) * a.levelMeshletRanges.size()) == 0);
+}
@@ -0,0 +1,140 @@
+#include "Test.h"
+#include "LevelCompare.h"
+#include <map>
+
+namespace fs = std::filesystem;
+
+// A scratch copy of GameLevel and its models, the test edits .h2b files so it can't use Assets directly
+static bool CopyGameLevel(const fs::path& folder)
+{
+	std::error_code error;
+	fs::remove_all(folder, error);
+	fs::create_directories(folder / "Models", error);
+	fs::copy_file(AssetPath("GameLevel.txt"), folder / "GameLevel.txt", error);
+	for (const fs::directory_entry& file : fs::directory_iterator(AssetPath("Models"), error))
+		if (file.path().extension() == ".h2b")
+			fs::copy_file(file.path(), folder / "Models" / file.path().filename(), error);
+	return !error;
+}
+
+// last write time of every cache file, a model that was imported again has its cache rewritten
+static std::map<std::string, fs::file_time_type> CacheTimes(const fs::path& cacheFolder)
+{
+	std::map<std::string, fs::file_time_type> times;
+	std::error_code error;
+	for (const fs::directory_entry& file : fs::directory_iterator(cacheFolder, error))
+		times[file.path().filename().string()] = file.last_write_time(error);
+	return times;
+}
+
+// moves every cache file back in time so a rewrite shows up whatever the file system's clock resolution
+static void AgeCaches(const fs::path& cacheFolder)
+{
+	std::error_code error;
+	for (const fs::directory_entry& file : fs::directory_iterator(cacheFolder, error))
+		fs::last_write_time(file.path(), file.last_write_time(error) - std::chrono::hours(1), error);
+}
+
+static unsigned CountRewritten(const std::map<std::string, fs::file_time_type>& before,
+	const std::map<std::string, fs::file_time_type>& after)
+{
+	unsigned rewritten = 0;
+	for (const auto& cache : after) {
+		auto old = before.find(cache.first);
+		rewritten += old == before.end() || old->second != cache.second;
+	}
+	return rewritten;
+}
+
+// loads the scratch level through the cache and reports how many models were imported again
+static unsigned LoadCached(const fs::path& folder, unsigned options, float lodRatio, Level_Data& level)
+{
+	const fs::path cacheFolder = folder / "Cache";
+	AgeCaches(cacheFolder);
+	auto before = CacheTimes(cacheFolder);
+	level.modelCacheFolder = cacheFolder.string();
+	level.lodRatio = lodRatio;
+	CHECK(level.LoadLevel((folder / "GameLevel.txt").string().c_str(), (folder / "Models").string().c_str(),
+		GW::SYSTEM::GLog(), options));
+	return CountRewritten(before, CacheTimes(cacheFolder));
+}
+
+static bool LoadUncached(const fs::path& folder, unsigned options, float lodRatio, Level_Data& level)
+{
+	level.lodRatio = lodRatio;
+	return level.LoadLevel((folder / "GameLevel.txt").string().c_str(), (folder / "Models").string().c_str(),
+		GW::SYSTEM::GLog(), options);
+}
+
+TEST(ModelCache, ReimportsOnlyChangedModels)
+{
+	const fs::path folder = fs::temp_directory_path() / "Wing3D_ModelCacheTests";
+	CHECK(CopyGameLevel(folder));
+	const unsigned options = Level_Data::IMPORT_OPTIMIZE_MESHES | Level_Data::IMPORT_LODS;
+	Level_Data reference;
+	CHECK(LoadUncached(folder, options, 0.5f, reference));
+	const unsigned modelCount = static_cast<unsigned>(reference.levelModels.size());
+	CHECK(modelCount > 1);
+	if (modelCount < 2)
+		return;
+	// cold cache, every model is imported and saved
+	Level_Data first;
+	CHECK(LoadCached(folder, options, 0.5f, first) == modelCount);
+	CHECK(CacheTimes(folder / "Cache").size() == modelCount);
+	CHECK(SameLevel(first, reference));
+	// warm cache, nothing is imported
+	Level_Data second;
+	CHECK(LoadCached(folder, options, 0.5f, second) == 0);
+	CHECK(SameLevel(second, reference));
+	// a newer file with the same contents is still a hit, only the contents are hashed
+	const fs::path changed = folder / "Models" / reference.levelModels[1].filename;
+	std::error_code error;
+	fs::last_write_time(changed, fs::file_time_type::clock::now() + std::chrono::hours(1), error);
+	Level_Data touched;
+	CHECK(LoadCached(folder, options, 0.5f, touched) == 0);
+	CHECK(SameLevel(touched, reference));
+	// raise the first vertex of one model, only that model is imported again
+	float height = 0;
+	{
+		std::fstream file(changed, std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+		file.seekg(20 + 4); // after the header, at the first vertex's pos.y
+		file.read(reinterpret_cast<char*>(&height), 4);
+		height += 1.0f;
+		file.seekp(20 + 4);
+		file.write(reinterpret_cast<const char*>(&height), 4);
+		CHECK(file.good());
+	}
+	Level_Data edited, editedReference;
+	CHECK(LoadCached(folder, options, 0.5f, edited) == 1);
+	CHECK(LoadUncached(folder, options, 0.5f, editedReference));
+	CHECK(SameLevel(edited, editedReference));
+	CHECK(SameLevel(edited, reference) == false);
+	fs::remove_all(folder, error);
+}
+
+TEST(ModelCache, OptionsInvalidateCache)
+{
+	const fs::path folder = fs::temp_directory_path() / "Wing3D_ModelCacheTests";
+	CHECK(CopyGameLevel(folder));
+	const unsigned options = Level_Data::IMPORT_OPTIMIZE_MESHES | Level_Data::IMPORT_LODS;
+	Level_Data first;
+	const unsigned modelCount = LoadCached(folder, options, 0.5f, first);
+	CHECK(modelCount == first.levelModels.size() && modelCount > 0);
+	// every per model option is part of what a cache was built from
+	Level_Data welded, weldedReference;
+	CHECK(LoadCached(folder, options | Level_Data::IMPORT_WELD_VERTICES, 0.5f, welded) == modelCount);
+	CHECK(LoadUncached(folder, options | Level_Data::IMPORT_WELD_VERTICES, 0.5f, weldedReference));
+	CHECK(SameLevel(welded, weldedReference));
+	// and so are the settings those options use
+	Level_Data coarser, coarserReference;
+	CHECK(LoadCached(folder, options | Level_Data::IMPORT_WELD_VERTICES, 0.25f, coarser) == modelCount);
+	CHECK(LoadUncached(folder, options | Level_Data::IMPORT_WELD_VERTICES, 0.25f, coarserReference));
+	CHECK(SameLevel(coarser, coarserReference));
+	// level wide steps run after the cache, switching them keeps every model
+	Level_Data levelWide;
+	CHECK(LoadCached(folder, options | Level_Data::IMPORT_WELD_VERTICES | Level_Data::IMPORT_16BIT_INDICES,
+		0.25f, levelWide) == 0);
+	CHECK(levelWide.levelIndices16.size() + levelWide.levelIndices32.size() > 0);
+	std::error_code error;
+	fs::remove_all(folder, error);
+}
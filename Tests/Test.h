@@ -0,0 +1,45 @@
+#ifndef _TEST_H_
+#define _TEST_H_
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Just enough of a test framework for Wing3D_Tests. TEST(group, name) registers a test,
+// CHECK reports a failed condition and keeps going so one run shows every problem.
+// Running Wing3D_Tests with a group name only runs that group, ctest runs each group on its own.
+struct TEST_CASE {
+	const char* group;
+	const char* name;
+	void (*run)();
+};
+inline std::vector<TEST_CASE>& TestCases()
+{
+	static std::vector<TEST_CASE> cases;
+	return cases;
+}
+inline unsigned& TestFailures()
+{
+	static unsigned failures = 0;
+	return failures;
+}
+struct TEST_REGISTRAR {
+	TEST_REGISTRAR(const char* group, const char* name, void (*run)()) { TestCases().push_back({ group, name, run }); }
+};
+
+#define TEST(group, name) \
+	static void group##_##name(); \
+	static TEST_REGISTRAR group##_##name##_registrar(#group, #name, group##_##name); \
+	static void group##_##name()
+
+#define CHECK(condition) do { \
+	if (!(condition)) { \
+		++TestFailures(); \
+		std::printf("%s(%d): CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+	} } while (0)
+
+// absolute path of something in the repository's Assets folder
+inline std::string AssetPath(const char* relative)
+{
+	return std::string(WING3D_SOURCE_DIR) + "/Assets/" + relative;
+}
+#endif
@@ -0,0 +1,23 @@
+#include "Test.h"
+#include <cstring>
+
+// Wing3D_Tests [group]: runs every test, or only those of one group. Returns how many checks failed.
+int main(int argc, char** argv)
+{
+	const char* group = (argc > 1) ? argv[1] : nullptr;
+	unsigned ran = 0;
+	for (const TEST_CASE& test : TestCases()) {
+		if (group != nullptr && std::strcmp(group, test.group) != 0)
+			continue;
+		const unsigned failuresBefore = TestFailures();
+		test.run();
+		std::printf("%s %s.%s\n", TestFailures() == failuresBefore ? "PASS" : "FAIL", test.group, test.name);
+		++ran;
+	}
+	if (ran == 0) {
+		std::printf("no tests in group %s\n", group ? group : "(all)");
+		return 1;
+	}
+	std::printf("%u tests, %u failed checks\n", ran, TestFailures());
+	return TestFailures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,138 @@
+#include "Test.h"
+#include "../Source/Utils/UploadRing.h"
+#include <random>
+
+TEST(UploadRing, AllocateWrapAndRetire)
+{
+	UploadRing ring;
+	ring.Reset(1024);
+	CHECK(ring.Allocate(100, 256) == 0);
+	CHECK(ring.Allocate(100, 256) == 256);
+	ring.FinishFrame(1); // frame 1 holds [0, 356)
+	CHECK(ring.Allocate(300, 256) == 512);
+	ring.FinishFrame(2); // frame 2 holds [512, 812)
+	CHECK(ring.Allocate(300, 256) == UploadRing::INVALID_OFFSET); // no room at the end or the front
+	ring.Retire(0);
+	CHECK(ring.FramesInFlight() == 2);
+	ring.Retire(1);
+	CHECK(ring.FramesInFlight() == 1);
+	// frame 1 is done, wraps to the front and leaves [812, 1024) unused until frame 2 is
+	CHECK(ring.Allocate(300, 256) == 0);
+	CHECK(ring.Used() == (156 + 300) + 212 + 300); // frame 2 counts its alignment gap too
+	CHECK(ring.Allocate(300, 256) == UploadRing::INVALID_OFFSET); // would run into frame 2
+	ring.FinishFrame(3);
+	ring.Retire(2);
+	CHECK(ring.Allocate(301, 256) == UploadRing::INVALID_OFFSET);
+	CHECK(ring.Allocate(300, 256) == 512);
+	CHECK(ring.Allocate(1, 1) == UploadRing::INVALID_OFFSET); // full up to frame 3's start
+	ring.FinishFrame(4);
+	ring.Retire(4);
+	CHECK(ring.Used() == 0);
+	CHECK(ring.FramesInFlight() == 0);
+	CHECK(ring.Allocate(1024, 1) == 0); // empty again, the whole capacity fits
+}
+
+TEST(UploadRing, EmptyFramesRetireSafely)
+{
+	UploadRing ring;
+	ring.Reset(512);
+	CHECK(ring.Allocate(200, 1) == 0);
+	ring.FinishFrame(1);
+	ring.FinishFrame(2); // nothing allocated
+	ring.Retire(1);
+	// starts over from the front, the empty frame's stale end must not move tail past it
+	CHECK(ring.Allocate(300, 1) == 0);
+	ring.FinishFrame(3);
+	ring.Retire(2);
+	CHECK(ring.Used() == 300);
+	CHECK(ring.Allocate(300, 1) == UploadRing::INVALID_OFFSET);
+	CHECK(ring.Allocate(200, 1) == 300);
+}
+
+// random allocations, frame ends and fence progress checked against an owner for every byte
+TEST(UploadRing, RandomizedNeverOverlaps)
+{
+	std::mt19937 random(7);
+	unsigned allocations = 0, wraps = 0, overlaps = 0, refusedWhenEmpty = 0;
+	for (int trial = 0; trial < 100; ++trial) {
+		const size_t capacity = 256 + random() % 8192;
+		UploadRing ring;
+		ring.Reset(capacity);
+		std::vector<int> owner(capacity, -1); // frame each byte belongs to
+		std::vector<std::vector<std::pair<size_t, size_t>>> frames(1);
+		unsigned long long fence = 0, completed = 0;
+		size_t lastOffset = 0, liveBytes = 0;
+		for (int step = 0; step < 2000; ++step) {
+			const unsigned operation = random() % 10;
+			if (operation < 6) {
+				const size_t size = 1 + random() % (capacity / 3), alignment = size_t(1) << (random() % 9);
+				const size_t offset = ring.Allocate(size, alignment);
+				if (offset == UploadRing::INVALID_OFFSET) {
+					refusedWhenEmpty += liveBytes == 0 && size <= capacity;
+					continue;
+				}
+				++allocations;
+				wraps += offset < lastOffset;
+				lastOffset = offset;
+				CHECK(offset % alignment == 0);
+				CHECK(offset + size <= capacity);
+				if (offset + size > capacity)
+					return;
+				for (size_t b = offset; b < offset + size; ++b) {
+					overlaps += owner[b] != -1;
+					owner[b] = static_cast<int>(frames.size() - 1);
+				}
+				liveBytes += size;
+				frames.back().push_back({ offset, size });
+			}
+			else if (operation < 8) {
+				ring.FinishFrame(++fence);
+				frames.emplace_back();
+			}
+			else {
+				// the GPU catches up by a random number of frames
+				if (completed < fence)
+					completed += 1 + random() % (fence - completed);
+				ring.Retire(completed);
+				for (unsigned long long f = 0; f < completed; ++f) {
+					for (const std::pair<size_t, size_t>& allocation : frames[f]) {
+						std::fill(owner.begin() + allocation.first, owner.begin() + allocation.first + allocation.second, -1);
+						liveBytes -= allocation.second;
+					}
+					frames[f].clear();
+				}
+				CHECK(ring.FramesInFlight() == fence - completed);
+			}
+		}
+		ring.FinishFrame(++fence);
+		ring.Retire(fence);
+		CHECK(ring.Used() == 0);
+		CHECK(ring.Allocate(capacity, 1) == 0);
+	}
+	CHECK(overlaps == 0);
+	CHECK(refusedWhenEmpty == 0);
+	CHECK(allocations > 10000 && wraps > 1000);
+}
+
+// the renderer's pattern: a few buffers every frame with the GPU some frames behind
+TEST(UploadRing, SteadyFramesNeverRefused)
+{
+	const size_t sizes[3] = { 64 * 20000, 80 * 40, 4 * 20050 };
+	size_t frameBytes = 0;
+	for (size_t size : sizes)
+		frameBytes += (size + 255) & ~size_t(255);
+	for (unsigned lag = 1; lag <= 3; ++lag) {
+		// one frame being written and lag frames the GPU may still read
+		UploadRing ring;
+		ring.Reset(frameBytes * (lag + 1));
+		unsigned refused = 0;
+		for (unsigned long long frame = 1; frame <= 1000; ++frame) {
+			if (frame > 1)
+				ring.FinishFrame(frame - 1);
+			ring.Retire(frame > lag + 1 ? frame - 1 - lag : 0);
+			for (size_t size : sizes)
+				refused += ring.Allocate(size, 256) == UploadRing::INVALID_OFFSET;
+		}
+		CHECK(refused == 0);
+	}
+}
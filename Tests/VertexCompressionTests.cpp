@@ -0,0 +1,128 @@
+#include "Test.h"
+#include "../Source/Utils/lvlData.h"
+#include <random>
+
+// half precision keeps an 11 bit mantissa, below 2^-14 the spacing stops shrinking at 2^-24
+static bool WithinHalfPrecision(float value, float decoded)
+{
+	return std::fabs(decoded - value) <= std::fmax(std::fabs(value) * 0.00048828125f, 2.98023224e-8f);
+}
+
+// angle between a normal and its decoded copy, normals don't have to be unit length
+static double NormalError(const H2B::VECTOR& normal, const H2B::VECTOR& decoded)
+{
+	double length = std::sqrt(double(normal.x) * normal.x + double(normal.y) * normal.y + double(normal.z) * normal.z);
+	double c = (normal.x * decoded.x + normal.y * decoded.y + normal.z * decoded.z) / length;
+	return std::acos(std::fmin(1.0, std::fmax(-1.0, c)));
+}
+
+// furthest a decoded position may land from the original: half a step plus float rounding of the decode
+static bool WithinHalfStep(float value, float decoded, float offset, float scale)
+{
+	float slack = 4.0f * FLT_EPSILON * (std::fabs(offset) + std::fabs(scale));
+	return std::fabs(decoded - value) <= scale / 65535.0f * 0.5f + slack;
+}
+
+TEST(VertexCompression, HalfFloatConversion)
+{
+	// every finite half survives a trip through float
+	unsigned wrong = 0;
+	for (unsigned bits = 0; bits < 0x10000; ++bits)
+		if (((bits >> 10) & 0x1F) != 0x1F)
+			wrong += H2B::FloatToHalf(H2B::HalfToFloat(static_cast<unsigned short>(bits))) != bits;
+	CHECK(wrong == 0);
+	CHECK(H2B::FloatToHalf(1.0f) == 0x3C00);
+	CHECK(H2B::FloatToHalf(-2.0f) == 0xC000);
+	CHECK(H2B::FloatToHalf(65504.0f) == 0x7BFF);
+	CHECK(H2B::FloatToHalf(65520.0f) == 0x7C00); // rounds past the largest half to infinity
+	CHECK(H2B::FloatToHalf(5.96046448e-8f) == 0x0001); // smallest denormal
+	CHECK(H2B::FloatToHalf(1.0f + 0.00048828125f) == 0x3C00); // ties go to even
+	CHECK(H2B::FloatToHalf(1.0f + 3 * 0.00048828125f) == 0x3C02);
+	std::mt19937 random(3);
+	std::uniform_real_distribution<float> uv(-8.0f, 8.0f);
+	unsigned outside = 0;
+	for (int i = 0; i < 100000; ++i) {
+		float value = uv(random) * ((i % 4 == 0) ? 1e-4f : 1.0f);
+		outside += WithinHalfPrecision(value, H2B::HalfToFloat(H2B::FloatToHalf(value))) == false;
+	}
+	CHECK(outside == 0);
+}
+
+TEST(VertexCompression, OctahedralNormals)
+{
+	std::mt19937 random(5);
+	std::uniform_real_distribution<float> component(-1.0f, 1.0f);
+	double worst = 0;
+	for (int i = 0; i < 200000; ++i) {
+		H2B::VECTOR normal = { component(random), component(random), component(random) };
+		if (i < 6) // the axes, where the octahedron folds
+			normal = { (i == 0) - float(i == 1), (i == 2) - float(i == 3), (i == 4) - float(i == 5) };
+		if (std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z) < 1e-3f)
+			continue;
+		short encoded[2];
+		H2B::OctEncode(normal, encoded);
+		worst = std::fmax(worst, NormalError(normal, H2B::OctDecode(encoded)));
+	}
+	CHECK(worst < 0.001);
+	short encoded[2];
+	H2B::OctEncode({ 0, 0, 0 }, encoded);
+	H2B::VECTOR up = H2B::OctDecode(encoded);
+	CHECK(up.x == 0 && up.y == 0 && up.z == 1);
+}
+
+TEST(VertexCompression, PositionsWithinHalfStep)
+{
+	std::mt19937 random(9);
+	std::uniform_real_distribution<float> position(-250.0f, 750.0f);
+	std::vector<H2B::VERTEX> vertices(5000);
+	for (H2B::VERTEX& vertex : vertices) {
+		vertex = {};
+		vertex.pos = { position(random), 3.5f, position(random) * 0.01f }; // y is flat
+		vertex.nrm = { 0, 1, 0 };
+	}
+	H2B::QUANTIZATION quantization = H2B::ComputeQuantization(vertices.data(), static_cast<unsigned>(vertices.size()));
+	CHECK(quantization.scale.y == 0 && quantization.offset.y == 3.5f);
+	unsigned outside = 0, lowest = 65535, highest = 0;
+	for (const H2B::VERTEX& vertex : vertices) {
+		H2B::COMPACT_VERTEX compact = H2B::EncodeVertex(vertex, quantization);
+		H2B::VERTEX decoded = H2B::DecodeVertex(compact, quantization);
+		outside += !WithinHalfStep(vertex.pos.x, decoded.pos.x, quantization.offset.x, quantization.scale.x);
+		outside += decoded.pos.y != vertex.pos.y; // a flat axis decodes exactly
+		outside += !WithinHalfStep(vertex.pos.z, decoded.pos.z, quantization.offset.z, quantization.scale.z);
+		lowest = std::min<unsigned>(lowest, compact.pos[0]);
+		highest = std::max<unsigned>(highest, compact.pos[0]);
+	}
+	CHECK(outside == 0);
+	CHECK(lowest == 0 && highest == 65535); // the bounds use the whole unorm range
+	CHECK(H2B::ComputeQuantization(nullptr, 0).scale.x == 0);
+}
+
+TEST(VertexCompression, GameLevelCompactVertices)
+{
+	Level_Data level;
+	CHECK(level.LoadLevel(AssetPath("GameLevel.txt").c_str(), AssetPath("Models").c_str(), GW::SYSTEM::GLog(),
+		Level_Data::IMPORT_COMPACT_VERTICES));
+	CHECK(level.levelCompactVertices.size() == level.levelVertices.size());
+	CHECK(level.levelQuantization.size() == level.levelModels.size());
+	if (level.levelCompactVertices.size() != level.levelVertices.size() ||
+		level.levelQuantization.size() != level.levelModels.size())
+		return;
+	unsigned positions = 0, uvs = 0, normals = 0;
+	for (unsigned m = 0; m < level.levelModels.size(); ++m) {
+		const Level_Data::LEVEL_MODEL& model = level.levelModels[m];
+		const H2B::QUANTIZATION& q = level.levelQuantization[m];
+		for (unsigned v = model.vertexStart; v < model.vertexStart + model.vertexCount; ++v) {
+			const H2B::VERTEX& original = level.levelVertices[v];
+			H2B::VERTEX decoded = H2B::DecodeVertex(level.levelCompactVertices[v], q);
+			positions += !WithinHalfStep(original.pos.x, decoded.pos.x, q.offset.x, q.scale.x) ||
+				!WithinHalfStep(original.pos.y, decoded.pos.y, q.offset.y, q.scale.y) ||
+				!WithinHalfStep(original.pos.z, decoded.pos.z, q.offset.z, q.scale.z);
+			uvs += !WithinHalfPrecision(original.uvw.x, decoded.uvw.x) || !WithinHalfPrecision(original.uvw.y, decoded.uvw.y);
+			if (std::fabs(original.nrm.x) + std::fabs(original.nrm.y) + std::fabs(original.nrm.z) > 1e-3f)
+				normals += NormalError(original.nrm, decoded.nrm) >= 0.001;
+		}
+	}
+	CHECK(positions == 0);
+	CHECK(uvs == 0);
+	CHECK(normals == 0);
+}